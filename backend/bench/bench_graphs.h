@@ -0,0 +1,81 @@
+#ifndef BENCH_GRAPHS_H
+#define BENCH_GRAPHS_H
+// Synthetic graphs and a timer shared by the benchmarks in this directory.
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../include/graph.h"
+#include "../include/algorithms.h"
+// side x side grid around Jaipur, ~100 m spacing, with jittered positions.
+// Weights are travel minutes at a random speed in [20, maxKmh] km/h.
+inline Graph benchGrid(int side, double maxKmh=40.0, uint32_t seed=5) {
+    Graph g;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> U(0,1);
+    std::vector<std::pair<double,double>> pos;
+    for (int i=0; i<side*side; ++i) {
+        Attraction a;
+        a.id=i;
+        a.name="n"+std::to_string(i);
+        a.latitude=26.8+(i/side)*0.0009+U(rng)*0.0003;
+        a.longitude=75.7+(i%side)*0.001+U(rng)*0.0003;
+        pos.push_back({a.latitude,a.longitude});
+        g.addAttraction(a);
+    }
+    auto road=[&](int u,int v) {
+        double m=haversine(pos[u].first,pos[u].second,pos[v].first,pos[v].second);
+        g.addEdge(u,v,m/1000.0/(20.0+U(rng)*(maxKmh-20.0))*60.0);
+    };
+    for (int r=0; r<side; ++r)
+        for (int c=0; c<side; ++c) {
+            int i=r*side+c;
+            if (c+1<side) road(i,i+1);
+            if (r+1<side) road(i,i+side);
+        }
+    g.freeze();
+    g.buildDSU();
+    return g;
+}
+// Road-like: a grid with a quarter of its streets missing, plus sparse fast
+// arterials every 10 rows/columns, so degrees vary and shortest paths bend.
+inline Graph benchRoadLike(int side, uint32_t seed=7) {
+    Graph g;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> U(0,1);
+    for (int i=0; i<side*side; ++i) {
+        Attraction a;
+        a.id=i;
+        a.name="n"+std::to_string(i);
+        a.latitude=26.8+(i/side)*0.0009;
+        a.longitude=75.7+(i%side)*0.001;
+        g.addAttraction(a);
+    }
+    for (int r=0; r<side; ++r)
+        for (int c=0; c<side; ++c) {
+            int i=r*side+c;
+            bool arterialRow=r%10==0,arterialCol=c%10==0;
+            if (c+1<side && (arterialRow || U(rng)<0.75)) g.addEdge(i,i+1,arterialRow ? 0.1+U(rng)*0.05 : 0.3+U(rng)*0.3);
+            if (r+1<side && (arterialCol || U(rng)<0.75)) g.addEdge(i,i+side,arterialCol ? 0.1+U(rng)*0.05 : 0.3+U(rng)*0.3);
+        }
+    g.freeze();
+    g.buildDSU();
+    return g;
+}
+// Random connected (source, target) pairs; the same seed gives the same queries.
+inline std::vector<std::pair<int,int>> benchQueries(const Graph& g, int count, uint32_t seed=3) {
+    std::mt19937 rng(seed);
+    std::vector<std::pair<int,int>> q;
+    while ((int)q.size()<count) {
+        int s=(int)(rng()%g.size()),t=(int)(rng()%g.size());
+        if (g.getComponent(s)==g.getComponent(t)) q.push_back({s,t});
+    }
+    return q;
+}
+inline double benchMillis(std::chrono::steady_clock::time_point since) {
+    return std::chrono::duration<double,std::milli>(std::chrono::steady_clock::now()-since).count();
+}
+#endif
@@ -0,0 +1,80 @@
+// One-to-all Dijkstra with a lazy std::priority_queue vs the indexed D-ary heap
+// (D = 2, 4, 8) on the same graphs, sources and distance arrays.
+#include <cstdio>
+#include <queue>
+#include "bench_graphs.h"
+#include "../include/indexed_heap.h"
+using namespace std;
+namespace {
+struct QueueStats {
+    double checksum=0;
+    long long pushes=0; // pushes, or pushes plus decrease-keys for the indexed heap
+    long long maxSize=0;
+};
+void lazyDijkstra(const Graph& g,int s,vector<double>& dist,QueueStats& st) {
+    priority_queue<pair<double,int>,vector<pair<double,int>>,greater<pair<double,int>>> pq;
+    dist.assign(g.size(),numeric_limits<double>::infinity());
+    dist[s]=0;
+    pq.push({0,s});
+    ++st.pushes;
+    while (!pq.empty()) {
+        st.maxSize=max(st.maxSize,(long long)pq.size());
+        auto [d,u]=pq.top();
+        pq.pop();
+        if (d>dist[u]) continue; // stale duplicate
+        st.checksum+=d;
+        for (Neighbor nb:g.neighbors(u))
+            if (d+nb.weight<dist[nb.id]) {
+                dist[nb.id]=d+nb.weight;
+                pq.push({dist[nb.id],nb.id});
+                ++st.pushes;
+            }
+    }
+}
+template <int D>
+void indexedDijkstra(const Graph& g,int s,vector<double>& dist,IndexedHeap<D>& pq,QueueStats& st) {
+    dist.assign(g.size(),numeric_limits<double>::infinity());
+    pq.resize(g.size());
+    dist[s]=0;
+    pq.pushOrDecrease(s,0);
+    ++st.pushes;
+    while (!pq.empty()) {
+        st.maxSize=max(st.maxSize,(long long)pq.size());
+        auto [d,u]=pq.pop();
+        st.checksum+=d;
+        for (Neighbor nb:g.neighbors(u))
+            if (d+nb.weight<dist[nb.id]) {
+                dist[nb.id]=d+nb.weight;
+                pq.pushOrDecrease(nb.id,dist[nb.id]);
+                ++st.pushes;
+            }
+    }
+}
+template <typename Search>
+void measure(const char* graphName,const char* queueName,const vector<pair<int,int>>& queries,Search search) {
+    QueueStats st;
+    auto t0=chrono::steady_clock::now();
+    for (auto& q:queries) search(q.first,st);
+    double ms=benchMillis(t0);
+    printf("%-10s %-22s %8.3f ms/query %10lld key updates/query %8lld max size (checksum %.1f)\n",graphName,queueName,
+        ms/queries.size(),st.pushes/(long long)queries.size(),st.maxSize,st.checksum);
+}
+void run(const char* graphName,const Graph& g) {
+    auto queries=benchQueries(g,50);
+    vector<double> dist;
+    IndexedHeap<2> h2;
+    IndexedHeap<4> h4;
+    IndexedHeap<8> h8;
+    measure(graphName,"lazy priority_queue",queries,[&](int s,QueueStats& st) { lazyDijkstra(g,s,dist,st); });
+    measure(graphName,"IndexedHeap<2>",queries,[&](int s,QueueStats& st) { indexedDijkstra(g,s,dist,h2,st); });
+    measure(graphName,"IndexedHeap<4>",queries,[&](int s,QueueStats& st) { indexedDijkstra(g,s,dist,h4,st); });
+    measure(graphName,"IndexedHeap<8>",queries,[&](int s,QueueStats& st) { indexedDijkstra(g,s,dist,h8,st); });
+}
+}
+int main() {
+    Graph grid=benchGrid(300);
+    run("grid",grid);
+    Graph road=benchRoadLike(300);
+    run("road-like",road);
+    return 0;
+}
@@ -0,0 +1,84 @@
+// Allocations and time per Dijkstra query: getNeighbors() copies vs the
+// NeighborRange view, and the library search on a reused workspace.
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <queue>
+#include "bench_graphs.h"
+#include "../include/search_workspace.h"
+using namespace std;
+static uint64_t allocations=0;
+void* operator new(size_t n) {
+    ++allocations;
+    if (void* p=malloc(n ? n : 1)) return p;
+    throw bad_alloc();
+}
+void operator delete(void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+namespace {
+typedef priority_queue<pair<double,int>,vector<pair<double,int>>,greater<pair<double,int>>> LazyQueue;
+// the search as it was: one adjacency copy per settled node
+double copyingDijkstra(const Graph& g,int s,int t,vector<double>& dist,LazyQueue& pq) {
+    dist.assign(g.size(),numeric_limits<double>::infinity());
+    dist[s]=0;
+    pq.push({0,s});
+    while (!pq.empty()) {
+        auto [d,u]=pq.top();
+        pq.pop();
+        if (d>dist[u]) continue;
+        if (u==t) break;
+        for (auto& p:g.getNeighbors(u))
+            if (d+p.second<dist[p.first]) { dist[p.first]=d+p.second; pq.push({dist[p.first],p.first}); }
+    }
+    while (!pq.empty()) pq.pop();
+    return dist[t];
+}
+// the same loop over the zero-copy range
+double rangeDijkstra(const Graph& g,int s,int t,vector<double>& dist,LazyQueue& pq) {
+    dist.assign(g.size(),numeric_limits<double>::infinity());
+    dist[s]=0;
+    pq.push({0,s});
+    while (!pq.empty()) {
+        auto [d,u]=pq.top();
+        pq.pop();
+        if (d>dist[u]) continue;
+        if (u==t) break;
+        for (Neighbor nb:g.neighbors(u))
+            if (d+nb.weight<dist[nb.id]) { dist[nb.id]=d+nb.weight; pq.push({dist[nb.id],nb.id}); }
+    }
+    while (!pq.empty()) pq.pop();
+    return dist[t];
+}
+void run(const char* graphName,const Graph& g) {
+    auto queries=benchQueries(g,200);
+    vector<double> dist;
+    LazyQueue pq;
+    SearchWorkspace ws;
+    auto measure=[&](const char* name,const function<double(int,int)>& query) {
+        query(queries[0].first,queries[0].second); // warm-up: buffers reach full size
+        uint64_t before=allocations;
+        double check=0;
+        auto t0=chrono::steady_clock::now();
+        for (auto& q:queries) check+=query(q.first,q.second);
+        double ms=benchMillis(t0);
+        printf("%-10s %-32s %10.1f allocs/query %8.3f ms/query (checksum %.3f)\n",graphName,name,
+            (double)(allocations-before)/queries.size(),ms/queries.size(),check);
+    };
+    measure("getNeighbors copies",[&](int s,int t) { return copyingDijkstra(g,s,t,dist,pq); });
+    measure("NeighborRange",[&](int s,int t) { return rangeDijkstra(g,s,t,dist,pq); });
+    measure("dijkstraToTargets + workspace",[&](int s,int t) {
+        static vector<int> target(1);
+        target[0]=t;
+        return dijkstraToTargets(g,s,target,ws)[0]; // the row itself is one allocation
+    });
+}
+}
+int main() {
+    Graph grid=benchGrid(300);
+    run("grid",grid);
+    Graph road=benchRoadLike(300);
+    run("road-like",road);
+    return 0;
+}
@@ -2,13 +2,39 @@
 #define ALGORITHMS_H
 #include <vector>
 #include <utility>
+#include <cstddef>
+#include "edge.h"
 class Graph;
+class SearchWorkspace;
 // Dijkstra Algorithm(one for indivigual path,other is fur multiple paths required)
+// dijkstraSearch leaves distances/parents in ws; the two below copy them out
+void dijkstraSearch(const Graph& g, int start, SearchWorkspace& ws);
+// One-to-many: stops once every target is settled; row[i] is the distance to targets[i]
+std::vector<double> dijkstraToTargets(const Graph& g, int source, const std::vector<int>& targets, SearchWorkspace& ws);
+// Point-to-point: searches from both ends and stops once the frontiers prove the
+// best meeting point optimal. Returns {distance, path}, or {inf, {}} if unreachable.
+std::pair<double, std::vector<int>> bidirectionalDijkstra(const Graph& g, int source, int target, SearchWorkspace& fwd, SearchWorkspace& bwd);
+// Point-to-point on the fastest engine the graph's attached indexes allow
+// (all-pairs table, else Contraction Hierarchy, else ALT A* with landmarks,
+// else bidirectional Dijkstra), on this thread's workspaces. Returns
+// {distance, path}, or {inf, {}} if unreachable.
+std::pair<double, std::vector<int>> shortestPath(const Graph& g, int source, int target);
+// Distance table between two node sets: gathered from the all-pairs table, hub
+// labels or the hierarchy's bucket queries when the graph has them, else
+// bit-parallel BFS on uniform weights, else one target-bounded Dijkstra per
+// source.
+std::vector<std::vector<double>> distanceMatrix(const Graph& g, const std::vector<int>& sources, const std::vector<int>& targets);
 std::vector<double> dijkstra(const Graph& g, int start);
 std::pair<std::vector<double>, std::vector<int>> dijkstraWithPath(const Graph& g, int start);
 std::vector<int> reconstructPath(const std::vector<int>& parent, int start, int end);
-// A*
-std::vector<int> aStarPath(const Graph& g, int start, int goal);
+// A*. epsilon>0 runs weighted A* (f = g + (1+epsilon)*h): the path costs at
+// most (1+epsilon) times the optimum and usually settles far fewer nodes. The
+// count of settled nodes is left in threadWorkspace().settled().
+std::vector<int> aStarPath(const Graph& g, int start, int goal, double epsilon = 0.0);
+// Exact bidirectional A* (see potential_search.h) with averaged potentials:
+// altBidirectionalPath when landmarks are built, else the geometric bound. Settled nodes:
+// threadWorkspace() plus threadReverseWorkspace().
+std::vector<int> bidirectionalAStarPath(const Graph& g, int start, int goal);
 double haversine(double lat1, double lon1, double lat2, double lon2);
 // TSP
 //travelling salesman problem(2 opt improvement,along with greedy algorithm part)
@@ -18,12 +44,9 @@ std::pair<double, std::vector<int>> greedyTSP(const Graph& g, int start, const s
 void twoOptImprovement(std::vector<int>& tour, const std::vector<std::vector<double>>& dist);
 std::pair<double, std::vector<int>> computeOptimalRouteFree(const Graph& g, const std::vector<int>& locs);
 // Kruskal & MST
-struct Edge {
-    int u, v;
-    double weight;
-    bool operator<(const Edge& other) const { return weight < other.weight; }
-};
 std::vector<Edge> kruskalMST(std::vector<Edge>& edges, int n);
+// Same, for edges already sorted by weight (e.g. Graph::getAllEdges)
+std::vector<Edge> kruskalMSTSorted(const Edge* edges, size_t count, int n);
 std::vector<int> mstToTour(const std::vector<Edge>& mst, int n, int start);
 // Ordered route helper (fixed-order)
 std::pair<double, std::vector<int>> computeOrderedRoute(const Graph& g, const std::vector<int>& order);
@@ -0,0 +1,35 @@
+#ifndef ALL_PAIRS_H
+#define ALL_PAIRS_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "frozen_array.h"
+class Graph;
+// Graphs up to this many nodes may carry a dense all-pairs table
+// (n^2 doubles plus n^2 next hops: about 200 MB at the limit).
+const int APSP_MAX_NODES=4096;
+// Dense all-pairs shortest paths: every distance and, for path reconstruction,
+// the first hop of a shortest path from each node towards each other one.
+class AllPairsTable {
+private:
+    int nodeCount;
+    FrozenArray<double> dist;  // dist[u*n + v]
+    FrozenArray<int32_t> next; // next[u*n + v]: neighbour of u on a shortest u-v path, -1 if none
+public:
+    AllPairsTable(): nodeCount(0) {}
+    // Bit-parallel BFS when all weights are equal; else cache-blocked
+    // Floyd-Warshall for small or dense graphs, otherwise one Dijkstra per node
+    // spread over threads (0 = all cores). Returns null above APSP_MAX_NODES.
+    static std::shared_ptr<AllPairsTable> build(const Graph& g, int threads=0);
+    int size() const { return nodeCount; }
+    double distance(int u, int v) const;
+    // Node sequence u..v, empty if unreachable.
+    std::vector<int> path(int u, int v) const;
+    std::vector<std::vector<double>> distanceMatrix(const std::vector<int>& sources, const std::vector<int>& targets) const;
+    // Snapshot section payload (see SECTION_ALL_PAIRS).
+    void serialize(std::vector<char>& out) const;
+    static std::shared_ptr<AllPairsTable> fromSnapshot(std::shared_ptr<const MappedFile> file,
+        const char* data, std::size_t size, int nodeCount);
+};
+#endif
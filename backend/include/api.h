@@ -1,4 +1,5 @@
 #pragma once
+#include <memory>
 #include <string>
 #include <vector>
 #include "graph.h"
@@ -14,14 +15,18 @@ struct ApiResult {
     std::string errorMessage;
     std::vector<int> fullPath;
     std::vector<std::string> fullPathNames;
+    double suboptimalityBound;
+    unsigned long long settledNodes;
+    std::string legSearch;
 };
 
 // For choices 1 & 2 (TSP or Dijkstra)
 ApiResult runOptimizerAPI(
     int mode, 
     const std::vector<std::string>& locations,
-    Graph& graph
+    const std::shared_ptr<const GraphSnapshot>& graph,
+    const RouteOptions& options = RouteOptions()
 );
 
 // For choice 3 (Full campus traversal)
-ApiResult runFullGraphTraversal(Graph& graph);
+ApiResult runFullGraphTraversal(const std::shared_ptr<const GraphSnapshot>& graph, const RouteOptions& options = RouteOptions());
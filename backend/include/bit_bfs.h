@@ -0,0 +1,27 @@
+#ifndef BIT_BFS_H
+#define BIT_BFS_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+class Graph;
+const int BFS_BATCH=64; // sources per pass: one bit each in a uint64_t
+// Hop distances and BFS-tree predecessors from a list of sources. On a graph
+// with uniform weights (Graph::hasUniformWeights) hops times the weight are the
+// shortest-path distances.
+struct HopTable {
+    int nodeCount=0;
+    std::vector<int> sources;
+    std::vector<int32_t> hops; // hops[i*nodeCount + v] from sources[i]; -1 if unreachable
+    std::vector<int32_t> pred; // v's parent in the BFS tree of sources[i]; -1 at the root
+    int hopCount(int i, int v) const { return hops[(std::size_t)i*nodeCount+v]; }
+    // sources[i]..v, empty if unreachable. Roads are undirected, so reversed it
+    // is also a shortest v..sources[i] path.
+    std::vector<int> path(int i, int v) const;
+};
+// Bit-parallel BFS: 64 sources run together, one bit each in a machine word per
+// node, so a level costs one pass over the edges for the whole batch. Pass
+// g.getAllAttractionIds() for all pairs. With targets, a batch stops as soon as
+// every target is reached from all of its sources (or nothing more is
+// reachable); rows are then complete only for the targets.
+HopTable multiSourceBFS(const Graph& g, const std::vector<int>& sources, const std::vector<int>& targets = {});
+#endif
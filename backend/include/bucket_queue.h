@@ -0,0 +1,89 @@
+#ifndef BUCKET_QUEUE_H
+#define BUCKET_QUEUE_H
+#include <cstdint>
+#include <utility>
+#include <vector>
+// Monotone integer priority queues for Dijkstra on integer weights. Both are
+// lazy: a node may be queued more than once and the caller skips entries whose
+// key no longer matches the node's distance.
+
+// Dial's buckets: with edge weights in [0, C] every queued key lies in
+// [current, current+C], so C+1 circular buckets suffice and push/pop are O(1)
+// (plus the scan over empty buckets).
+class DialQueue {
+private:
+    std::vector<std::vector<int>> buckets;
+    uint64_t current;
+    std::size_t count;
+public:
+    DialQueue(): current(0), count(0) {}
+    void reset(uint32_t maxWeight) {
+        buckets.resize((std::size_t)maxWeight+1);
+        for (auto& b:buckets) b.clear();
+        current=0;
+        count=0;
+    }
+    bool empty() const { return count==0; }
+    void push(uint64_t key, int node) {
+        buckets[key%buckets.size()].push_back(node);
+        ++count;
+    }
+    std::pair<uint64_t, int> pop() {
+        std::vector<int>* b=&buckets[current%buckets.size()];
+        while (b->empty()) b=&buckets[++current%buckets.size()];
+        int node=b->back();
+        b->pop_back();
+        --count;
+        return {current,node};
+    }
+};
+
+// Radix heap: bucket i holds keys whose highest bit differing from the last
+// popped key is bit i-1. Popping refills bucket 0 by redistributing the first
+// non-empty bucket, so each entry moves O(log C) times in total.
+class RadixHeap {
+private:
+    static const int BUCKETS=65;
+    std::vector<std::pair<uint64_t, int>> buckets[BUCKETS];
+    uint64_t last;
+    std::size_t count;
+    static int bucketOf(uint64_t key, uint64_t last) {
+        uint64_t x=key^last;
+        if (x==0) return 0;
+#if defined(__GNUC__) || defined(__clang__)
+        return 64-__builtin_clzll(x);
+#else
+        int b=0;
+        while (x) { ++b; x>>=1; }
+        return b;
+#endif
+    }
+public:
+    RadixHeap(): last(0), count(0) {}
+    void reset() {
+        for (auto& b:buckets) b.clear();
+        last=0;
+        count=0;
+    }
+    bool empty() const { return count==0; }
+    void push(uint64_t key, int node) {
+        buckets[bucketOf(key,last)].push_back({key,node});
+        ++count;
+    }
+    std::pair<uint64_t, int> pop() {
+        if (buckets[0].empty()) {
+            int i=1;
+            while (buckets[i].empty()) ++i;
+            uint64_t mn=buckets[i][0].first;
+            for (auto& e:buckets[i]) if (e.first<mn) mn=e.first;
+            last=mn;
+            for (auto& e:buckets[i]) buckets[bucketOf(e.first,last)].push_back(e);
+            buckets[i].clear();
+        }
+        std::pair<uint64_t, int> top=buckets[0].back();
+        buckets[0].pop_back();
+        --count;
+        return top;
+    }
+};
+#endif
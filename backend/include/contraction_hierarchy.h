@@ -0,0 +1,56 @@
+#ifndef CONTRACTION_HIERARCHY_H
+#define CONTRACTION_HIERARCHY_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "frozen_array.h"
+class Graph;
+class SearchWorkspace;
+// Arc of the upward graph: from a node to a higher-ranked neighbour. middle is
+// the contracted node a shortcut bypasses, or -1 for an original road.
+struct CHArc {
+    int32_t target;
+    int32_t middle;
+    double weight;
+};
+// Contraction Hierarchy over an undirected frozen graph. Nodes are contracted
+// one by one (cheapest edge difference first), adding shortcuts wherever a
+// witness search finds no path around the contracted node. A query then only
+// climbs: both searches follow upward arcs and meet at the top of the path.
+class ContractionHierarchy {
+private:
+    int nodeCount;
+    FrozenArray<int> rank;     // contraction order, 0 = contracted first
+    FrozenArray<int> upOffset; // upward arcs of u: upArcs[upOffset[u] .. upOffset[u+1]), sorted by target
+    FrozenArray<CHArc> upArcs;
+    const CHArc* findArc(int a, int b) const;
+    bool stalled(int u, double d, const SearchWorkspace& ws) const;
+    void unpack(int a, int b, std::vector<int>& path) const;
+public:
+    ContractionHierarchy(): nodeCount(0) {}
+    // threads=0 uses every hardware thread for the initial node priorities.
+    static std::shared_ptr<ContractionHierarchy> build(const Graph& g, int threads=0);
+    int size() const { return nodeCount; }
+    int rankOf(int v) const { return rank[v]; }
+    std::size_t arcCount() const { return upArcs.size(); }
+    const CHArc* upwardBegin(int u) const { return upArcs.data()+upOffset[u]; }
+    const CHArc* upwardEnd(int u) const { return upArcs.data()+upOffset[u+1]; }
+    // Upward search from source into ws (distances and parents). settled gets
+    // the nodes whose distance is exact, i.e. that were not stalled.
+    void upwardSearch(int source, SearchWorkspace& ws, std::vector<int>& settled) const;
+    // Many-to-many table: row i holds the distances from sources[i] to every
+    // target. One upward search per target fills buckets at the nodes it
+    // reaches; one per source then scans the buckets of the nodes it reaches.
+    std::vector<std::vector<double>> distanceMatrix(const std::vector<int>& sources, const std::vector<int>& targets,
+        SearchWorkspace& ws) const;
+    // Returns {distance, path} with shortcuts expanded to original roads, or
+    // {inf, {}} if unreachable.
+    std::pair<double, std::vector<int>> shortestPath(int source, int target, SearchWorkspace& fwd, SearchWorkspace& bwd) const;
+    // Snapshot section payload (see SECTION_CONTRACTION_HIERARCHY).
+    void serialize(std::vector<char>& out) const;
+    static std::shared_ptr<ContractionHierarchy> fromSnapshot(std::shared_ptr<const MappedFile> file,
+        const char* data, std::size_t size, int nodeCount);
+};
+#endif
@@ -0,0 +1,22 @@
+#ifndef CSV_IMPORT_H
+#define CSV_IMPORT_H
+#include <string>
+class Graph;
+struct ImportStats {
+    long long attractionRows = 0;
+    long long roadRows = 0;
+    long long rejectedRows = 0;   // roads whose endpoints do not name an attraction
+    long long malformedFields = 0; // numeric fields that failed to parse (default kept)
+    double seconds = 0.0;
+    int threads = 0;
+    double rowsPerSecond() const {
+        return seconds > 0 ? (attractionRows + roadRows) / seconds : 0.0;
+    }
+};
+// Appends the rows of both CSVs (formats as in Graph::loadFromCSV) to g, then
+// freezes it and builds the DSU. Files are memory-mapped and split into chunks on
+// line boundaries; chunks are parsed with std::from_chars on up to `threads`
+// threads (0 = hardware concurrency) and merged in file order, so IDs and
+// adjacency order match a sequential load.
+ImportStats importGraphCSV(Graph& g, const std::string& attractionsFile, const std::string& roadsFile, int threads = 0);
+#endif
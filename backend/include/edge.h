@@ -0,0 +1,8 @@
+#ifndef EDGE_H
+#define EDGE_H
+struct Edge {
+    int u, v;
+    double weight;
+    bool operator<(const Edge& other) const { return weight < other.weight; }
+};
+#endif
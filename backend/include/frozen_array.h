@@ -0,0 +1,52 @@
+#ifndef FROZEN_ARRAY_H
+#define FROZEN_ARRAY_H
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+#include "mapped_file.h"
+// Read-only array that either owns its elements or views a section of a
+// memory-mapped snapshot (keeping the mapping alive). Copies of a mapped array
+// share the mapping; copies of an owned array copy the elements.
+template <typename T>
+class FrozenArray {
+private:
+    std::vector<T> owned;
+    std::shared_ptr<const MappedFile> mapping;
+    const T* ptr;
+    std::size_t count;
+public:
+    FrozenArray(): ptr(nullptr), count(0) {}
+    FrozenArray(const FrozenArray& o): owned(o.owned), mapping(o.mapping),
+        ptr(o.mapping ? o.ptr : owned.data()), count(o.count) {}
+    FrozenArray(FrozenArray&& o) noexcept: owned(std::move(o.owned)), mapping(std::move(o.mapping)),
+        ptr(mapping ? o.ptr : owned.data()), count(o.count) { o.ptr=nullptr; o.count=0; }
+    FrozenArray& operator=(FrozenArray o) {
+        owned.swap(o.owned);
+        mapping.swap(o.mapping);
+        ptr=mapping ? o.ptr : owned.data();
+        count=o.count;
+        return *this;
+    }
+    void assign(std::vector<T>&& v) {
+        mapping.reset();
+        owned=std::move(v);
+        ptr=owned.data();
+        count=owned.size();
+    }
+    void attach(std::shared_ptr<const MappedFile> file, const T* p, std::size_t n) {
+        owned.clear();
+        owned.shrink_to_fit();
+        mapping=std::move(file);
+        ptr=p;
+        count=n;
+    }
+    void clear() { assign(std::vector<T>()); }
+    const T* data() const { return ptr; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count==0; }
+    const T& operator[](std::size_t i) const { return ptr[i]; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr+count; }
+};
+#endif
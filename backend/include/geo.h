@@ -0,0 +1,44 @@
+#ifndef GEO_H
+#define GEO_H
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include "frozen_array.h"
+class Graph;
+const double EARTH_RADIUS_M=6371000.0;
+// Node positions as structure-of-arrays, precomputed once by freeze() and saved
+// in the snapshot: radians, cos(latitude), and the unit vector on the sphere.
+// Kernels below stream these arrays without trig per element, so their main
+// loops auto-vectorize. The arrays may live inside a mapped snapshot.
+struct GeoPoints {
+    FrozenArray<double> lat, lon, cosLat;
+    FrozenArray<double> x, y, z;
+    // latLonDegrees: n interleaved latitude/longitude pairs
+    void assign(const double* latLonDegrees, std::size_t n);
+    // fields: the lat, lon, cosLat, x, y and z arrays of n values each, back to back
+    void attach(std::shared_ptr<const MappedFile> file, const double* fields, std::size_t n);
+    std::size_t size() const { return lat.size(); }
+};
+// Great-circle distance in meters between points i and j, from the chord
+// between their unit vectors (same result as haversine, one asin instead of
+// five trig calls, and accurate down to millimetres).
+inline double greatCircleDistance(const GeoPoints& p, int i, int j) {
+    double dx=p.x[i]-p.x[j],dy=p.y[i]-p.y[j],dz=p.z[i]-p.z[j];
+    double half=0.5*std::sqrt(dx*dx+dy*dy+dz*dz);
+    return 2.0*EARTH_RADIUS_M*std::asin(half<1.0 ? half : 1.0);
+}
+// out[i] = great-circle distance in meters from (latDeg, lonDeg) to point i.
+void greatCircleBatch(double latDeg, double lonDeg, const GeoPoints& p, double* out);
+// out[i] = equirectangular (flat-earth) distance in meters from (latDeg, lonDeg)
+// to point i, using the mean of the two cos(latitude) values. Pure arithmetic.
+// Compared with the great-circle distance the relative error grows with the
+// square of the distance: measured below 1e-6 up to 10 km and 2.1e-5 up to
+// 50 km for latitudes within +-70 degrees. Not valid across the antimeridian.
+void equirectangularBatch(double latDeg, double lonDeg, const GeoPoints& p, double* out);
+// table[i][j] = great-circle distance in meters between rows[i] and cols[j].
+std::vector<std::vector<double>> greatCircleMatrix(const GeoPoints& p, const std::vector<int>& rows, const std::vector<int>& cols);
+// Spatial snapping: the node closest to (latDeg, lonDeg) among those with a
+// position, or -1 if none has one.
+int nearestNode(const Graph& g, double latDeg, double lonDeg);
+#endif
@@ -1,38 +1,189 @@
 #ifndef GRAPH_H
 #define GRAPH_H
+#include <cstdint>
 #include <unordered_map>
 #include <vector>
 #include <string>
-#include <map>
+#include <string_view>
+#include <memory>
 #include "attraction.h"
-#include "../include/dsu.h"
-struct Edge; 
+#include "edge.h"
+#include "frozen_array.h"
+#include "csv_import.h"
+#include "name_index.h"
+#include "geo.h"
+#include "snapshot.h"
+class LandmarkIndex;
+class ContractionHierarchy;
+class HubLabels;
+class AllPairsTable;
+struct Neighbor {
+    int id;
+    double weight;
+};
+// Non-owning view of one node's CSR slice; stays valid until the graph is
+// modified or re-frozen. Iterating it never allocates.
+class NeighborRange {
+private:
+    const int* targets;
+    const double* weights;
+    int count;
+public:
+    class iterator {
+    private:
+        const int* t;
+        const double* w;
+    public:
+        iterator(const int* t,const double* w): t(t), w(w) {}
+        Neighbor operator*() const { return {*t,*w}; }
+        iterator& operator++() { ++t; ++w; return *this; }
+        bool operator!=(const iterator& o) const { return t!=o.t; }
+        bool operator==(const iterator& o) const { return t==o.t; }
+    };
+    NeighborRange(): targets(nullptr), weights(nullptr), count(0) {}
+    NeighborRange(const int* t,const double* w,int n): targets(t), weights(w), count(n) {}
+    iterator begin() const { return iterator(targets,weights); }
+    iterator end() const { return iterator(targets+count,weights+count); }
+    int size() const { return count; }
+    bool empty() const { return count==0; }
+    Neighbor operator[](int i) const { return {targets[i],weights[i]}; }
+};
 class Graph {
 private:
-    std::unordered_map<int, Attraction> attractions;
-    std::unordered_map<int, std::vector<std::pair<int, double>>> adjList;
-    std::map<std::string, int> nameToId;
+    // Node IDs are dense indices [0, size()); attractions and adjList are indexed
+    // by them directly. Caller-supplied Attraction::id values are kept as external
+    // IDs and translated through externalToDense / denseToExternal.
+    std::vector<Attraction> attractions;
+    std::vector<std::vector<std::pair<int, double>>> adjList;
+    std::unordered_map<int, int> externalToDense;
+    std::vector<int> denseToExternal;
+    NameIndex nameToId;
     int numVertices;
-    DSU* dsu;
+    // DSU roots flattened by buildDSU(), so component queries are read-only and a
+    // shared const graph can answer them from several threads; saved in the snapshot
+    FrozenArray<int> component;
+    // Compressed-sparse-row copy of adjList built by freeze(): the neighbours of u
+    // are csrTarget/csrWeight[csrOffset[u] .. csrOffset[u+1]), indexed by node ID.
+    // The arrays may live inside a mapped snapshot (see loadSnapshot).
+    FrozenArray<int> csrOffset;
+    FrozenArray<int> csrTarget;
+    FrozenArray<double> csrWeight;
+    // Undirected edges with u<v, one per node pair (cheapest of parallel roads),
+    // sorted by weight; built by freeze()
+    FrozenArray<Edge> edgeList;
+    // Integer weight mode chosen by freeze(): if every weight times weightScale
+    // (1, 10, 100 or 1000) is a whole number, csrIntWeight holds the scaled
+    // weights and searches run on integer bucket queues. 0 = not integral.
+    FrozenArray<uint32_t> csrIntWeight;
+    // latitude/longitude pairs by node ID, so searches read coordinates without
+    // touching (or copying) Attraction records; built by freeze()
+    FrozenArray<double> coords;
+    GeoPoints geo; // the same positions prepared for the distance kernels in geo.h
+    int weightScale;
+    uint32_t maxIntWeight;
+    // Every road has this same positive weight (0 = weights differ). Such a graph
+    // is unweighted in disguise: hop counts times this weight are distances.
+    double uniformWeightValue;
+    // Smallest weight per meter of great-circle length over all roads, so
+    // geoCostPerMeter * distance is a lower bound on any route's cost (0 = no
+    // usable bound: some node with a road has no position, or a road is free).
+    double geoCostPerMeter;
+    bool frozen;
+    // The files loadFromCSV read, stamped before reading; saved in the snapshot
+    // header so snapshotIsCurrent can tell when they change
+    std::vector<SnapshotSourceStamp> sourceStamps;
+    // Optional search indexes derived from the frozen graph; dropped by any mutation
+    std::shared_ptr<const LandmarkIndex> landmarkIndex;
+    std::shared_ptr<const ContractionHierarchy> hierarchy;
+    std::shared_ptr<const HubLabels> hubLabels;
+    std::shared_ptr<const AllPairsTable> allPairsTable;
+    void thaw();
+    void dropDerivedIndexes();
+    void clearAll();
+    void buildEdgeList();
+    void chooseWeightMode();
+    void buildCoordinates();
+    void calibrateGeoBound();
 public:
     Graph();
-    ~Graph();
-    void addAttraction(const Attraction& attr);
+    // Returns the dense ID assigned to attr (re-adding an external ID replaces it).
+    int addAttraction(const Attraction& attr);
     void addEdge(int from, int to, double weight);
     std::vector<std::pair<int, double>> getNeighbors(int nodeId) const;
     Attraction getAttraction(int id) const;
+    // O(log degree) on a frozen graph: CSR rows are sorted by target. With
+    // parallel roads the cheapest one is returned.
     double getEdgeWeight(int from, int to) const;
+    bool hasEdge(int from, int to) const;
+    // Sum of edge weights along path; infinity if some hop is not an edge.
+    double pathCost(const std::vector<int>& path) const;
     int size() const { return numVertices; }
     std::vector<int> getAllAttractionIds() const;
     bool hasAttraction(int id) const;
-    int getIdByName(const std::string& name) const;
-    void loadFromCSV(const std::string& attractionsFile, const std::string& roadsFile);
+    int getIdByName(std::string_view name) const { return nameToId.find(name); }
+    // attractions.csv: name,category,rating,duration,fee,popularity,latitude,longitude
+    // roads.csv: from,to,time (attraction names). Parsed by importGraphCSV.
+    ImportStats loadFromCSV(const std::string& attractionsFile, const std::string& roadsFile);
+    // Binary snapshot (format in snapshot.h). loadSnapshot maps the file and points
+    // the CSR arrays straight into it; nothing is parsed.
+    bool saveSnapshot(const std::string& path) const;
+    bool loadSnapshot(const std::string& path);
     void buildDSU();
-    DSU* getDSU() const { return dsu; }
-    int getComponent(int id) const { return dsu ? dsu->find(id) : -1; }
+    bool hasComponents() const { return !component.empty(); }
+    int getComponent(int id) const {
+        return (id>=0 && id<(int)component.size()) ? component[id] : -1;
+    }
     bool isValidAttraction(int id) const;
     bool isFullyConnected() const;
-    std::vector<Edge> getAllEdges() const;
-    int maxNodeId() const;
+    const FrozenArray<Edge>& getAllEdges() const { return edgeList; }
+    int maxNodeId() const { return numVertices-1; }
+    int denseId(int externalId) const;
+    int externalId(int id) const;
+    // Searches run on the CSR arrays, so freeze() must follow the last addEdge
+    // (loadFromCSV does this itself). Any later addAttraction/addEdge unfreezes.
+    void freeze();
+    bool isFrozen() const { return frozen; }
+    bool hasIntegerWeights() const { return weightScale>0; }
+    int integerWeightScale() const { return weightScale; }
+    uint32_t maxIntegerWeight() const { return maxIntWeight; }
+    // coords is rebuilt by freeze(); until then positions come from the records
+    double latitudeOf(int id) const { return frozen ? coords[2*(std::size_t)id] : attractions[id].latitude; }
+    double longitudeOf(int id) const { return frozen ? coords[2*(std::size_t)id+1] : attractions[id].longitude; }
+    // (0, 0) is how the importer leaves a missing position
+    bool hasCoordinates(int id) const { return latitudeOf(id)!=0 || longitudeOf(id)!=0; }
+    const GeoPoints& geoPoints() const { return geo; }
+    // Admissible and consistent A* heuristic in weight units (0 everywhere when
+    // the graph has no usable bound, see geoCostPerMeter).
+    double geometricLowerBound(int from, int to) const {
+        return geoCostPerMeter>0 ? geoCostPerMeter*greatCircleDistance(geo,from,to) : 0.0;
+    }
+    bool hasGeometricBound() const { return geoCostPerMeter>0; }
+    double geometricCostPerMeter() const { return geoCostPerMeter; }
+    bool hasUniformWeights() const { return uniformWeightValue>0; }
+    double uniformWeight() const { return uniformWeightValue; }
+    // Scaled weights of neighbors(nodeId), in the same order.
+    const uint32_t* intWeightsOf(int nodeId) const { return csrIntWeight.data()+csrOffset[nodeId]; }
+    // ALT landmarks (see landmarks.h): built here, or restored by loadSnapshot.
+    void buildLandmarks(int k);
+    const LandmarkIndex* landmarks() const { return landmarkIndex.get(); }
+    // Contraction Hierarchy (see contraction_hierarchy.h); threads=0 uses all cores.
+    void buildContractionHierarchy(int threads=0);
+    const ContractionHierarchy* contractionHierarchy() const { return hierarchy.get(); }
+    // Hub labels (see hub_labels.h), derived from the hierarchy (built first if
+    // missing). Logs label size and build time.
+    void buildHubLabels();
+    const HubLabels* hubLabelIndex() const { return hubLabels.get(); }
+    // Dense all-pairs table (see all_pairs.h); false if the graph is too large.
+    bool buildAllPairs(int threads=0);
+    const AllPairsTable* allPairs() const { return allPairsTable.get(); }
+    NeighborRange neighbors(int nodeId) const {
+        if (nodeId<0 || nodeId+1>=(int)csrOffset.size()) return NeighborRange();
+        int b=csrOffset[nodeId];
+        return NeighborRange(csrTarget.data()+b,csrWeight.data()+b,csrOffset[nodeId+1]-b);
+    }
 };
+// A frozen Graph shared read-only by any number of RouteOptimizers and threads.
+// Only its const interface is reachable, and no const member mutates state.
+using GraphSnapshot = Graph;
+std::shared_ptr<const GraphSnapshot> makeSnapshot(Graph&& g);
 #endif
@@ -0,0 +1,49 @@
+#ifndef HUB_LABELS_H
+#define HUB_LABELS_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "frozen_array.h"
+class ContractionHierarchy;
+// Hub labeling distance oracle. Every node stores a label: the hubs (nodes of
+// its upward CH search space) with exact distances to them. Any two labels
+// share the top node of the shortest path between their owners, so
+// distance(u,v) is the minimum of d(u,h)+d(v,h) over common hubs, found by one
+// merge of two sorted arrays.
+//
+// When the graph has integer weights (weightScale>0) the distances are stored
+// as uint32 multiples of 1/scale, 8 bytes per entry instead of 12. Other graphs
+// keep double distances: float would make the oracle inexact.
+class HubLabels {
+private:
+    int nodeCount;
+    // label of v: hub[offset[v] .. offset[v+1]) (CH ranks, ascending) and the
+    // matching distances, kept as flat arrays so a merge streams both
+    FrozenArray<uint32_t> offset;
+    FrozenArray<uint32_t> hub;
+    int distScale;                  // 0: dist[] is used, else scaledDist[]
+    FrozenArray<double> dist;
+    FrozenArray<uint32_t> scaledDist; // distance*distScale
+public:
+    HubLabels(): nodeCount(0), distScale(0) {}
+    // Labels are built top-down in CH order and pruned of entries that another
+    // hub already beats, so only exact distances remain. weightScale is the
+    // graph's integer weight scale (0 if none); labels whose distances do not
+    // fit it fall back to doubles.
+    static std::shared_ptr<HubLabels> build(const ContractionHierarchy& ch, int weightScale=0);
+    int size() const { return nodeCount; }
+    std::size_t entryCount() const { return hub.size(); }
+    int scale() const { return distScale; }
+    std::size_t bytes() const {
+        return (offset.size()+hub.size()+scaledDist.size())*sizeof(uint32_t)+dist.size()*sizeof(double);
+    }
+    // Infinity if u and v are disconnected or out of range.
+    double distance(int u, int v) const;
+    std::vector<std::vector<double>> distanceMatrix(const std::vector<int>& sources, const std::vector<int>& targets) const;
+    // Snapshot section payload (see SECTION_HUB_LABELS).
+    void serialize(std::vector<char>& out) const;
+    static std::shared_ptr<HubLabels> fromSnapshot(std::shared_ptr<const MappedFile> file,
+        const char* data, std::size_t size, int nodeCount);
+};
+#endif
@@ -0,0 +1,82 @@
+#ifndef INDEXED_HEAP_H
+#define INDEXED_HEAP_H
+#include <utility>
+#include <vector>
+// Addressable D-ary min-heap of (key, node) with decrease-key. Every node sits
+// in the heap at most once, so it never holds stale entries and stays O(V)
+// rather than O(E). pos[v] is v's slot, or -1 when v is not in the heap; that
+// invariant makes clear() cost O(size) rather than O(V).
+template <int D = 4>
+class IndexedHeap {
+    static_assert(D >= 2, "heap arity must be at least 2");
+private:
+    std::vector<std::pair<double, int>> items;
+    std::vector<int> pos;
+    void place(int i, const std::pair<double, int>& it) {
+        items[i]=it;
+        pos[it.second]=i;
+    }
+    void siftUp(int i) {
+        std::pair<double, int> it=items[i];
+        while (i>0) {
+            int p=(i-1)/D;
+            if (!(it.first<items[p].first)) break;
+            place(i,items[p]);
+            i=p;
+        }
+        place(i,it);
+    }
+    void siftDown(int i) {
+        std::pair<double, int> it=items[i];
+        int n=(int)items.size();
+        while (true) {
+            int first=i*D+1;
+            if (first>=n) break;
+            int last=first+D<n ? first+D : n;
+            int best=first;
+            for (int c=first+1; c<last; ++c)
+                if (items[c].first<items[best].first) best=c;
+            if (!(items[best].first<it.first)) break;
+            place(i,items[best]);
+            i=best;
+        }
+        place(i,it);
+    }
+public:
+    // Makes node IDs [0, n) addressable.
+    void resize(int n) { if ((int)pos.size()<n) pos.resize(n,-1); }
+    void clear() {
+        for (auto& it:items) pos[it.second]=-1;
+        items.clear();
+    }
+    bool empty() const { return items.empty(); }
+    int size() const { return (int)items.size(); }
+    bool contains(int v) const { return pos[v]>=0; }
+    double keyOf(int v) const { return items[pos[v]].first; }
+    const std::pair<double, int>& top() const { return items[0]; }
+    // Inserts v, or lowers its key if already present with a larger one.
+    void pushOrDecrease(int v, double key) {
+        int i=pos[v];
+        if (i<0) {
+            items.push_back({key,v});
+            pos[v]=(int)items.size()-1;
+            siftUp((int)items.size()-1);
+        } else if (key<items[i].first) {
+            items[i].first=key;
+            siftUp(i);
+        }
+    }
+    std::pair<double, int> pop() {
+        std::pair<double, int> t=items[0];
+        pos[t.second]=-1;
+        std::pair<double, int> last=items.back();
+        items.pop_back();
+        if (!items.empty()) {
+            items[0]=last;
+            pos[last.second]=0;
+            siftDown(0);
+        }
+        return t;
+    }
+};
+#endif
@@ -0,0 +1,35 @@
+#ifndef LANDMARKS_H
+#define LANDMARKS_H
+#include <memory>
+#include <utility>
+#include <vector>
+#include "frozen_array.h"
+class Graph;
+class SearchWorkspace;
+// ALT preprocessing: exact distances from k landmarks to every node. By the
+// triangle inequality |d(L,u) - d(L,v)| <= d(u,v) for each landmark L, which
+// gives admissible, consistent A* bounds that need no coordinates.
+class LandmarkIndex {
+private:
+    int nodeCount;
+    std::vector<int> landmarkIds;
+    FrozenArray<double> table; // node-major: table[v*k + i] = d(landmark i, v)
+public:
+    LandmarkIndex(): nodeCount(0) {}
+    // Farthest selection: each new landmark is the node farthest from those
+    // already chosen (unreached nodes first, so every component gets one).
+    static std::shared_ptr<LandmarkIndex> build(const Graph& g, int k);
+    int count() const { return (int)landmarkIds.size(); }
+    const std::vector<int>& landmarks() const { return landmarkIds; }
+    // Lower bound on d(u, v); infinity when a landmark shows they are disconnected.
+    double lowerBound(int u, int v) const;
+    // Snapshot section payload (see SECTION_LANDMARKS).
+    void serialize(std::vector<char>& out) const;
+    static std::shared_ptr<LandmarkIndex> fromSnapshot(std::shared_ptr<const MappedFile> file,
+        const char* data, std::size_t size, int nodeCount);
+};
+// ALT queries: A* and bidirectional A* with landmark bounds. Return {distance, path}.
+std::pair<double, std::vector<int>> altPath(const Graph& g, const LandmarkIndex& lm, int source, int target, SearchWorkspace& ws);
+std::pair<double, std::vector<int>> altBidirectionalPath(const Graph& g, const LandmarkIndex& lm, int source, int target,
+    SearchWorkspace& fwd, SearchWorkspace& bwd);
+#endif
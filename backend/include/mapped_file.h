@@ -0,0 +1,28 @@
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+#include <cstddef>
+#include <string>
+// Read-only memory mapping of a whole file (mmap on POSIX, MapViewOfFile on Windows).
+// Pages are faulted in on first touch, so opening a large file costs no reads up front.
+class MappedFile {
+private:
+    const char* base;
+    std::size_t length;
+#ifdef _WIN32
+    void* fileHandle;
+    void* mapHandle;
+#else
+    int fd;
+#endif
+public:
+    MappedFile();
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+    const char* data() const { return base; }
+    std::size_t size() const { return length; }
+};
+#endif
@@ -0,0 +1,39 @@
+#ifndef NAME_INDEX_H
+#define NAME_INDEX_H
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+// Flat open-addressing (linear probing) table from names to node IDs. Names are
+// interned into one string pool, and lookups hash a string_view, so find() never
+// allocates. Inserting an existing name replaces its ID.
+class NameIndex {
+private:
+    struct Slot {
+        uint32_t hash;
+        int32_t id;       // EMPTY or TOMBSTONE when unused
+        uint32_t offset;  // name = pool[offset, offset+length)
+        uint32_t length;
+    };
+    static const int32_t EMPTY=-1;
+    static const int32_t TOMBSTONE=-2;
+    std::vector<Slot> slots; // size is zero or a power of two
+    std::string pool;
+    int count;
+    int used; // live + tombstones, drives rehashing
+    static uint32_t hashName(std::string_view name);
+    void rehash(size_t capacity);
+    bool matches(const Slot& s, uint32_t h, std::string_view name) const {
+        return s.id>=0 && s.hash==h && s.length==name.size() &&
+               pool.compare(s.offset,s.length,name.data(),name.size())==0;
+    }
+public:
+    NameIndex(): count(0), used(0) {}
+    void clear();
+    void reserve(size_t names);
+    void insert(std::string_view name, int id);
+    void erase(std::string_view name);
+    int find(std::string_view name) const; // -1 if absent
+    int size() const { return count; }
+};
+#endif
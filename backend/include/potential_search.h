@@ -0,0 +1,91 @@
+#ifndef POTENTIAL_SEARCH_H
+#define POTENTIAL_SEARCH_H
+#include <limits>
+#include <utility>
+#include <vector>
+#include "graph.h"
+#include "search_workspace.h"
+// Goal-directed searches parameterised by node potentials (lower bounds on
+// remaining distance). With consistent potentials every node is settled once.
+// Each direction evaluates a node's potential once (cached in its workspace).
+
+// A* from source to target; toTarget(v) must not overestimate d(v, target).
+// Returns the distance (infinity if unreachable); the path is ws.pathTo(source, target).
+template <typename PotentialToTarget>
+double aStarSearch(const Graph& g, int source, int target, SearchWorkspace& ws, PotentialToTarget toTarget) {
+    const double INF=std::numeric_limits<double>::infinity();
+    int n=g.maxNodeId()+1;
+    ws.reset(n);
+    if (!g.isValidAttraction(source) || !g.isValidAttraction(target)) return INF;
+    if (!(toTarget(source)<INF)) return INF; // bound already proves target unreachable
+    ws.set(source,0.0,-1);
+    ws.heap.pushOrDecrease(source,ws.potential(source,toTarget));
+    while (!ws.heap.empty()) {
+        int u=ws.heap.pop().second;
+        ws.countSettled();
+        if (u==target) return ws.distance(u);
+        double d=ws.distance(u);
+        for (Neighbor nb:g.neighbors(u)) {
+            int v=nb.id;
+            if (v<0 || v>=n) continue;
+            double nd=d+nb.weight;
+            if (ws.distance(v)>nd) {
+                ws.set(v,nd,u);
+                ws.heap.pushOrDecrease(v,nd+ws.potential(v,toTarget));
+            }
+        }
+    }
+    return INF;
+}
+
+// Bidirectional A* with averaged potentials pf(v) = (toTarget(v) - fromSource(v)) / 2
+// forward and -pf backward. Both are consistent when the bounds are, and the
+// reduced costs are the same in both directions, so the search may stop as soon
+// as the two frontier keys sum to at least the best path found.
+// Returns {distance, path}, or {inf, {}} if unreachable.
+template <typename PotentialToTarget, typename PotentialFromSource>
+std::pair<double, std::vector<int>> bidirectionalAStarSearch(const Graph& g, int source, int target,
+    SearchWorkspace& fwd, SearchWorkspace& bwd, PotentialToTarget toTarget, PotentialFromSource fromSource) {
+    const double INF=std::numeric_limits<double>::infinity();
+    int n=g.maxNodeId()+1;
+    fwd.reset(n);
+    bwd.reset(n);
+    if (!g.isValidAttraction(source) || !g.isValidAttraction(target)) return {INF,{}};
+    if (source==target) return {0.0,{source}};
+    if (!(toTarget(source)<INF)) return {INF,{}};
+    auto pf=[&](int v) { return 0.5*(toTarget(v)-fromSource(v)); };
+    fwd.set(source,0.0,-1);
+    bwd.set(target,0.0,-1);
+    fwd.heap.pushOrDecrease(source,fwd.potential(source,pf));
+    bwd.heap.pushOrDecrease(target,-bwd.potential(target,pf));
+    double best=INF;
+    int meet=-1;
+    while (!fwd.heap.empty() && !bwd.heap.empty()) {
+        if (fwd.heap.top().first+bwd.heap.top().first>=best) break;
+        bool forward=fwd.heap.top().first<=bwd.heap.top().first;
+        SearchWorkspace& ws=forward ? fwd : bwd;
+        SearchWorkspace& other=forward ? bwd : fwd;
+        double sign=forward ? 1.0 : -1.0;
+        int u=ws.heap.pop().second;
+        ws.countSettled();
+        double d=ws.distance(u);
+        for (Neighbor nb:g.neighbors(u)) {
+            int v=nb.id;
+            if (v<0 || v>=n) continue;
+            double nd=d+nb.weight;
+            if (ws.distance(v)>nd) {
+                ws.set(v,nd,u);
+                ws.heap.pushOrDecrease(v,nd+sign*ws.potential(v,pf));
+            }
+            if (other.reached(v) && nd+other.distance(v)<best) {
+                best=nd+other.distance(v);
+                meet=v;
+            }
+        }
+    }
+    if (meet==-1) return {INF,{}};
+    std::vector<int> path=fwd.pathTo(source,meet);
+    for (int x=bwd.parentOf(meet); x!=-1; x=bwd.parentOf(x)) path.push_back(x);
+    return {best,path};
+}
+#endif
@@ -2,6 +2,7 @@
 #define ROUTE_OPTIMIZER_H
 
 #include "graph.h"
+#include <memory>
 #include <vector>
 #include <string>
 
@@ -10,14 +11,34 @@ struct RouteResult {
     std::vector<int> fullPath;
     double totalTime = 0.0;
     std::string algorithm;
+    // totalTime is at most this factor times the exact cost of the same stop order
+    double suboptimalityBound = 1.0;
+    // nodes settled by the searches behind this route's legs, hierarchy queries
+    // included (all-pairs lookups settle none)
+    unsigned long long settledNodes = 0;
+    // how the legs were found: "all-pairs table", "contraction hierarchy",
+    // "bidirectional A*" or "weighted A*" (epsilon>0 skips the indexes)
+    std::string legSearch;
+};
+
+struct RouteOptions {
+    // 0 = exact legs; >0 routes every leg with weighted A* (see aStarPath),
+    // trading up to epsilon relative cost for speed, e.g. for previews
+    double epsilon = 0.0;
 };
 
 class RouteOptimizer {
 private:
-    Graph graph;
+    // shared, never copied: one snapshot serves every optimizer and thread
+    std::shared_ptr<const GraphSnapshot> snapshot;
+    RouteOptions options;
+    std::vector<int> searchLeg(int from, int to, RouteResult& res) const;
+    std::pair<double, std::vector<int>> routeLeg(int from, int to, RouteResult& res) const;
+    const char* legSearchName(bool indexed) const;
 public:
     RouteOptimizer() = default;
-    void setGraph(const Graph& g){ graph = g;}
+    void setGraph(std::shared_ptr<const GraphSnapshot> g){ snapshot = std::move(g);}
+    void setOptions(const RouteOptions& o){ options = o;}
     RouteResult computeOptimalRoute(const std::vector<int>& locations, bool flexibleOrder);
     RouteResult computeFullGraphRoute();
 };
@@ -0,0 +1,24 @@
+#ifndef SEARCH_INDEXES_H
+#define SEARCH_INDEXES_H
+class Graph;
+// Optional search indexes a deployment chooses to build, read from the
+// environment so each install can weigh build time and snapshot size (both
+// logged) against query speed:
+//   NAVRA_ALL_PAIRS=1    dense all-pairs table (n^2 memory and snapshot space,
+//                        graphs up to APSP_MAX_NODES only)
+//   NAVRA_HUB_LABELS=1   hub labels for distance matrices
+struct SearchIndexOptions {
+    bool allPairs=false;
+    bool hubLabels=false;
+    static SearchIndexOptions fromEnvironment();
+};
+// Builds only the indexes the query precedence in shortestPath/distanceMatrix
+// (all-pairs > hub labels > hierarchy > landmarks) would consult: landmarks
+// always (bidirectional A* legs use them too); the all-pairs table when enabled
+// and the graph fits, which then answers every query the hierarchy and hub
+// labels could; otherwise the Contraction Hierarchy, plus hub labels when enabled.
+void buildSearchIndexes(Graph& g, const SearchIndexOptions& options);
+// True if g carries exactly the set buildSearchIndexes(g, options) builds, so a
+// snapshot made under other options gets rebuilt.
+bool hasSearchIndexes(const Graph& g, const SearchIndexOptions& options);
+#endif
@@ -0,0 +1,66 @@
+#ifndef SEARCH_WORKSPACE_H
+#define SEARCH_WORKSPACE_H
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include "indexed_heap.h"
+#include "bucket_queue.h"
+// Scratch state for shortest-path searches, meant to be reused (one per thread).
+// A node's dist/parent entries count only when its stamp equals the current
+// generation, so starting a query bumps a counter instead of refilling O(V)
+// arrays, and the heap keeps its capacity from one query to the next.
+const int SEARCH_HEAP_ARITY=4;
+class SearchWorkspace {
+private:
+    std::vector<double> dist;
+    std::vector<int> parent;
+    std::vector<uint32_t> stamp;
+    std::vector<uint32_t> markStamp; // per-query node flags, e.g. pending targets
+    std::vector<double> potentialValue; // per-query cache of A* heuristic values
+    std::vector<uint32_t> potentialStamp;
+    uint32_t generation;
+    uint64_t settledCount;
+public:
+    // the search frontier, keyed by tentative distance (or f-score in A*)
+    IndexedHeap<SEARCH_HEAP_ARITY> heap;
+    // frontiers for graphs frozen with integer weights
+    DialQueue dial;
+    RadixHeap radix;
+    SearchWorkspace(): generation(0), settledCount(0) {}
+    // Starts a new query over node IDs [0, n).
+    void reset(int n);
+    int capacity() const { return (int)dist.size(); }
+    bool reached(int v) const { return stamp[v]==generation; }
+    double distance(int v) const {
+        return reached(v) ? dist[v] : std::numeric_limits<double>::infinity();
+    }
+    int parentOf(int v) const { return reached(v) ? parent[v] : -1; }
+    void set(int v, double d, int p) {
+        stamp[v]=generation;
+        dist[v]=d;
+        parent[v]=p;
+    }
+    bool marked(int v) const { return markStamp[v]==generation; }
+    void mark(int v) { markStamp[v]=generation; }
+    void unmark(int v) { markStamp[v]=0; }
+    // Heuristic value of v for this query's goal, computed on first use.
+    template <typename Heuristic>
+    double potential(int v, Heuristic h) {
+        if (potentialStamp[v]!=generation) {
+            potentialStamp[v]=generation;
+            potentialValue[v]=h(v);
+        }
+        return potentialValue[v];
+    }
+    // Nodes settled by the current query, for searches that count them.
+    void countSettled() { ++settledCount; }
+    uint64_t settled() const { return settledCount; }
+    // Path start..end following parents; empty if end was not reached from start.
+    std::vector<int> pathTo(int start, int end) const;
+};
+// The calling thread's workspace, and a second one for the backward half of
+// bidirectional searches.
+SearchWorkspace& threadWorkspace();
+SearchWorkspace& threadReverseWorkspace();
+#endif
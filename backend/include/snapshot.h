@@ -0,0 +1,90 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+#include <cstdint>
+#include <string>
+#include <vector>
+// Binary graph snapshot written by Graph::saveSnapshot and mapped by
+// Graph::loadSnapshot. Layout:
+//
+//   SnapshotHeader
+//   SnapshotSection[sectionCount]     section directory
+//   section payloads, each starting on an 8-byte boundary
+//
+// Integers are stored in native byte order; byteOrder lets a reader reject a
+// file written on a machine of the other endianness. Readers skip section kinds
+// they do not know, so derived indexes can be added without a version bump.
+const char SNAPSHOT_MAGIC[8]={'N','A','V','R','A','G','R','\0'};
+const uint32_t SNAPSHOT_VERSION=4;
+const uint32_t SNAPSHOT_BYTE_ORDER=0x01020304;
+enum SnapshotSectionKind : uint32_t {
+    SECTION_CSR_OFFSETS=1,  // int32[nodeCount+1]
+    SECTION_CSR_TARGETS=2,  // int32[edgeSlots]
+    SECTION_CSR_WEIGHTS=3,  // double[edgeSlots]
+    SECTION_COORDINATES=4,  // double[2*nodeCount], latitude/longitude pairs
+    SECTION_ATTRACTIONS=5,  // SnapshotAttraction[nodeCount]
+    SECTION_STRING_POOL=6,  // char[], referenced by SnapshotString
+    SECTION_EDGE_LIST=7,    // Edge[], canonical weight-sorted list (optional)
+    SECTION_LANDMARKS=8,    // ALT landmark distances, layout in landmarks.cpp (optional)
+    SECTION_CONTRACTION_HIERARCHY=9, // ranks and upward arcs, layout in contraction_hierarchy.cpp (optional)
+    SECTION_HUB_LABELS=10,  // hub labels, layout in hub_labels.cpp (optional)
+    SECTION_ALL_PAIRS=11,   // dense distance and next-hop tables, layout in all_pairs.cpp (optional)
+    SECTION_WEIGHT_MODE=12, // SnapshotWeightMode, then uint32[edgeSlots] scaled weights if scale>0 (optional)
+    SECTION_GEO_POINTS=13,  // double[6*nodeCount], GeoPoints lat, lon, cosLat, x, y, z arrays (optional)
+    SECTION_COMPONENTS=14   // int32[nodeCount], connected-component root per node (optional)
+};
+// Size and modification time (nanoseconds since the epoch) of a source file,
+// taken just before the graph was read from it.
+struct SnapshotSourceStamp {
+    uint64_t size;
+    int64_t mtimeNs;
+};
+const uint32_t SNAPSHOT_MAX_SOURCES=4;
+struct SnapshotHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t nodeCount;
+    uint32_t edgeSlots;
+    uint32_t sectionCount;
+    uint32_t sourceCount; // stamps in use, in the order the sources were given
+    SnapshotSourceStamp sources[SNAPSHOT_MAX_SOURCES];
+    double geoCostPerMeter; // calibrated A* bound, see Graph::calibrateGeoBound
+};
+struct SnapshotSection {
+    uint32_t kind;
+    uint32_t reserved;
+    uint64_t offset;
+    uint64_t size;
+};
+struct SnapshotString {
+    uint32_t offset;
+    uint32_t length;
+};
+// The weight mode Graph::freeze chose, so a load maps it instead of re-deriving it.
+struct SnapshotWeightMode {
+    int32_t scale;         // integer weight scale, 0 = weights are not integral
+    uint32_t maxIntWeight;
+    double uniformWeight;  // 0 = weights differ
+};
+// Tags are stored as one string joined with SNAPSHOT_TAG_SEPARATOR.
+const char SNAPSHOT_TAG_SEPARATOR='\x1f';
+struct SnapshotAttraction {
+    int32_t externalId;
+    int32_t popularity;
+    double visitDuration;
+    double rating;
+    double entryFee;
+    SnapshotString name;
+    SnapshotString category;
+    SnapshotString description;
+    SnapshotString openingHours;
+    SnapshotString tags;
+};
+// Stamps path; false if it cannot be examined (e.g. does not exist).
+bool stampSourceFile(const std::string& path, SnapshotSourceStamp& out);
+// True if snapshotPath is a readable snapshot built from exactly these sources
+// and every one that still exists has the recorded size and modification time.
+// Equality, not "older than", so an edit within the same second as the snapshot
+// write (or a restored older file) still counts as a change.
+bool snapshotIsCurrent(const std::string& snapshotPath, const std::vector<std::string>& sources);
+#endif
@@ -1,9 +1,13 @@
+#include <cmath>
 #include <iostream>
 #include <string>
 #include <vector>
 #include "include/json.hpp"
 #include "include/graph.h"
+#include "include/geo.h"
+#include "include/snapshot.h"
 #include "include/api.h"
+#include "include/search_indexes.h"
 
 using json = nlohmann::json;
 using namespace std;
@@ -42,12 +46,49 @@ int main() {
 
         int choice = j["choice"];
         int count = j["count"];
-        vector<string> names = j["locations"];
+        const json& locations = j["locations"];
+        if (!locations.is_array()) {
+            json err;
+            err["success"] = false;
+            err["error"] = "locations must be an array";
+            cout << err.dump() << endl;
+            cout.flush();
+            return 1;
+        }
 
-        // Load graph
+        // Optional "epsilon": accept routes up to (1 + epsilon) times the
+        // optimal leg cost in exchange for faster weighted A* searches. Any
+        // epsilon > 0 bypasses the all-pairs table and contraction hierarchy:
+        // every leg is searched, and the output's "legSearch" says so
+        RouteOptions options;
+        if (j.contains("epsilon")) {
+            const json& e = j["epsilon"];
+            if (!e.is_number() || !(e.get<double>() >= 0) || !isfinite(e.get<double>())) {
+                json err;
+                err["success"] = false;
+                err["error"] = "epsilon must be a finite number >= 0";
+                cout << err.dump() << endl;
+                cout.flush();
+                return 1;
+            }
+            options.epsilon = e.get<double>();
+        }
+
+        // Load graph: map the binary snapshot while the CSVs are unchanged since it was built
+        // (and it carries the indexes this deployment is configured for), otherwise parse
+        // the CSVs and refresh the snapshot for the next request
+        SearchIndexOptions indexOptions = SearchIndexOptions::fromEnvironment();
         Graph graph;
         try {
-            graph.loadFromCSV("attractions.csv", "roads.csv");
+            if (!snapshotIsCurrent("graph.snapshot", {"attractions.csv", "roads.csv"}) ||
+                !graph.loadSnapshot("graph.snapshot") || !hasSearchIndexes(graph, indexOptions)) {
+                graph.loadFromCSV("attractions.csv", "roads.csv");
+                // search indexes are built once here and reused from the snapshot
+                if (graph.size() > 0) {
+                    buildSearchIndexes(graph, indexOptions);
+                    graph.saveSnapshot("graph.snapshot");
+                }
+            }
         } catch (const exception& e) {
             json err;
             err["success"] = false;
@@ -57,6 +98,21 @@ int main() {
             return 1;
         }
 
+        // Each location is an attraction name, or {"lat": .., "lon": ..} snapped to
+        // the nearest attraction with a position
+        vector<string> names;
+        for (const json& loc : locations) {
+            if (loc.is_object() && loc.contains("lat") && loc.contains("lon")) {
+                int id = nearestNode(graph, loc["lat"].get<double>(), loc["lon"].get<double>());
+                names.push_back(id >= 0 ? graph.getAttraction(id).name : string());
+            } else {
+                names.push_back(loc.get<string>());
+            }
+        }
+
+        // Share one read-only graph with every optimizer instead of copying it
+        shared_ptr<const GraphSnapshot> snapshot = makeSnapshot(move(graph));
+
         // ------------------------------------------
         // Choice 4: Exit
         // ------------------------------------------
@@ -73,7 +129,7 @@ int main() {
         // Choice 3: Full campus traversal (MST + DFS + A*)
         // ------------------------------------------
         if (choice == 3) {
-            ApiResult result = runFullGraphTraversal(graph);
+            ApiResult result = runFullGraphTraversal(snapshot, options);
 
             json out;
             if (!result.success) {
@@ -89,6 +145,9 @@ int main() {
                 out["stopCount"] = result.stopCount;
                 out["fullPath"] = result.fullPath;
                 out["fullPathNames"] = result.fullPathNames;
+                out["suboptimalityBound"] = result.suboptimalityBound;
+                out["settledNodes"] = result.settledNodes;
+                out["legSearch"] = result.legSearch;
             }
             cout << out.dump() << endl;
             cout.flush();
@@ -98,7 +157,7 @@ int main() {
         // ------------------------------------------
         // Choices 1 & 2: TSP or Dijkstra
         // ------------------------------------------
-        ApiResult result = runOptimizerAPI(choice, names, graph);
+        ApiResult result = runOptimizerAPI(choice, names, snapshot, options);
 
         json out;
         if (!result.success) {
@@ -113,6 +172,9 @@ int main() {
             out["stopCount"] = result.stopCount;
             out["fullPath"] = result.fullPath;
             out["fullPathNames"] = result.fullPathNames;
+            out["suboptimalityBound"] = result.suboptimalityBound;
+            out["settledNodes"] = result.settledNodes;
+            out["legSearch"] = result.legSearch;
         }
         cout << out.dump() << endl;
         cout.flush();
@@ -0,0 +1,177 @@
+#include "../include/all_pairs.h"
+#include "../include/algorithms.h"
+#include "../include/bit_bfs.h"
+#include "../include/graph.h"
+#include "../include/search_workspace.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <thread>
+using namespace std;
+namespace {
+// Floyd-Warshall tile edge: three 64x64 tiles of doubles plus their next hops
+// stay inside L2.
+const int FW_BLOCK=64;
+// Floyd-Warshall is O(n^3) regardless of edges, repeated Dijkstra roughly
+// O(n m log n). Measured on random graphs, Floyd-Warshall's tight loops only
+// win up to FW_MAX_SPARSE_NODES nodes, or when the average degree is at least
+// n/2; at 512 nodes and degree 4 it is already 6x slower.
+const int FW_MAX_SPARSE_NODES=64;
+// c[i][j] = min(c[i][j], a[i][k] + b[k][j]) over k in one tile, for the tiles
+// starting at rows ib, columns jb and pivot kb.
+void relaxTile(double* d,int32_t* nx,int n,int ib,int jb,int kb) {
+    int ie=min(ib+FW_BLOCK,n),je=min(jb+FW_BLOCK,n),ke=min(kb+FW_BLOCK,n);
+    int w=je-jb;
+    double dk[FW_BLOCK];
+    for (int k=kb; k<ke; ++k) {
+        // local copy of row k: the compiler cannot otherwise rule out aliasing with row i
+        memcpy(dk,d+(size_t)k*n+jb,w*sizeof(double));
+        for (int i=ib; i<ie; ++i) {
+            double dik=d[(size_t)i*n+k];
+            if (dik==numeric_limits<double>::infinity()) continue;
+            int32_t hop=nx[(size_t)i*n+k];
+            double* di=d+(size_t)i*n+jb;
+            int32_t* ni=nx+(size_t)i*n+jb;
+            for (int j=0; j<w; ++j) {
+                double cand=dik+dk[j];
+                bool better=cand<di[j];
+                di[j]=better ? cand : di[j];
+                ni[j]=better ? hop : ni[j];
+            }
+        }
+    }
+}
+void floydWarshall(const Graph& g,int n,vector<double>& d,vector<int32_t>& nx) {
+    for (int u=0; u<n; ++u) {
+        d[(size_t)u*n+u]=0;
+        nx[(size_t)u*n+u]=u;
+        for (Neighbor nb:g.neighbors(u)) {
+            if (nb.id<0 || nb.id>=n || nb.id==u) continue;
+            size_t e=(size_t)u*n+nb.id;
+            if (nb.weight<d[e]) { d[e]=nb.weight; nx[e]=nb.id; }
+        }
+    }
+    // blocked order: pivot tile, then its row and column, then everything else
+    for (int kb=0; kb<n; kb+=FW_BLOCK) {
+        relaxTile(d.data(),nx.data(),n,kb,kb,kb);
+        for (int b=0; b<n; b+=FW_BLOCK) {
+            if (b==kb) continue;
+            relaxTile(d.data(),nx.data(),n,kb,b,kb);
+            relaxTile(d.data(),nx.data(),n,b,kb,kb);
+        }
+        for (int ib=0; ib<n; ib+=FW_BLOCK) {
+            if (ib==kb) continue;
+            for (int jb=0; jb<n; jb+=FW_BLOCK)
+                if (jb!=kb) relaxTile(d.data(),nx.data(),n,ib,jb,kb);
+        }
+    }
+}
+// One Dijkstra per target t. Roads are undirected, so t's shortest-path tree
+// also gives every node's next hop towards t: its parent in that tree.
+void repeatedDijkstra(const Graph& g,int n,int threads,vector<double>& d,vector<int32_t>& nx) {
+    auto run=[&](int lo,int hi) {
+        SearchWorkspace ws;
+        for (int t=lo; t<hi; ++t) {
+            dijkstraSearch(g,t,ws);
+            for (int s=0; s<n; ++s) {
+                d[(size_t)t*n+s]=ws.distance(s);
+                nx[(size_t)s*n+t]=s==t ? t : ws.parentOf(s);
+            }
+        }
+    };
+    threads=max(1,min(threads,n));
+    vector<thread> pool;
+    for (int i=1; i<threads; ++i) pool.emplace_back(run,(int)((long long)n*i/threads),(int)((long long)n*(i+1)/threads));
+    run(0,n/threads);
+    for (thread& t:pool) t.join();
+}
+// Uniform weights: bit-parallel BFS, 64 targets per pass over the edges. As in
+// repeatedDijkstra, a node's BFS-tree parent towards t is its next hop to t.
+void batchedBFS(const Graph& g,int n,vector<double>& d,vector<int32_t>& nx) {
+    double w=g.uniformWeight();
+    vector<int> batch;
+    for (int b=0; b<n; b+=BFS_BATCH) {
+        batch.clear();
+        for (int t=b; t<min(b+BFS_BATCH,n); ++t) batch.push_back(t);
+        HopTable h=multiSourceBFS(g,batch);
+        for (size_t i=0; i<batch.size(); ++i) {
+            int t=batch[i];
+            for (int s=0; s<n; ++s) {
+                int hops=h.hopCount((int)i,s);
+                if (hops<0) continue;
+                d[(size_t)t*n+s]=hops*w;
+                nx[(size_t)s*n+t]=s==t ? t : h.pred[i*n+s];
+            }
+        }
+    }
+}
+}
+shared_ptr<AllPairsTable> AllPairsTable::build(const Graph& g,int threads) {
+    int n=g.maxNodeId()+1;
+    if (n>APSP_MAX_NODES) return nullptr;
+    auto t=make_shared<AllPairsTable>();
+    t->nodeCount=max(n,0);
+    if (n<=0) return t;
+    vector<double> d((size_t)n*n,numeric_limits<double>::infinity());
+    vector<int32_t> nx((size_t)n*n,-1);
+    size_t slots=0;
+    for (int u=0; u<n; ++u) slots+=g.neighbors(u).size();
+    if (threads<=0) threads=max(1u,thread::hardware_concurrency());
+    if (g.hasUniformWeights()) batchedBFS(g,n,d,nx);
+    else if (n<=FW_MAX_SPARSE_NODES || slots*2>=(size_t)n*n) floydWarshall(g,n,d,nx);
+    else repeatedDijkstra(g,n,threads,d,nx);
+    t->dist.assign(move(d));
+    t->next.assign(move(nx));
+    return t;
+}
+double AllPairsTable::distance(int u,int v) const {
+    if (u<0 || v<0 || u>=nodeCount || v>=nodeCount) return numeric_limits<double>::infinity();
+    return dist[(size_t)u*nodeCount+v];
+}
+vector<int> AllPairsTable::path(int u,int v) const {
+    vector<int> p;
+    if (distance(u,v)==numeric_limits<double>::infinity()) return p;
+    p.push_back(u);
+    // a shortest path has at most n nodes; the bound, and checking each hop as it
+    // is read, also stop a damaged table (next hops are not validated on load)
+    while (u!=v && (int)p.size()<=nodeCount) {
+        u=next[(size_t)u*nodeCount+v];
+        if (u<0 || u>=nodeCount) return vector<int>();
+        p.push_back(u);
+    }
+    if (u!=v) return vector<int>();
+    return p;
+}
+vector<vector<double>> AllPairsTable::distanceMatrix(const vector<int>& sources,const vector<int>& targets) const {
+    vector<vector<double>> table(sources.size(),vector<double>(targets.size()));
+    for (size_t i=0; i<sources.size(); ++i)
+        for (size_t j=0; j<targets.size(); ++j) table[i][j]=distance(sources[i],targets[j]);
+    return table;
+}
+// Section layout: uint32 nodeCount, uint32 reserved, double dist[n*n], int32 next[n*n].
+void AllPairsTable::serialize(vector<char>& out) const {
+    uint32_t n=(uint32_t)nodeCount,reserved=0;
+    size_t cells=(size_t)n*n;
+    out.assign(8+cells*(sizeof(double)+sizeof(int32_t)),0);
+    memcpy(out.data(),&n,sizeof(n));
+    memcpy(out.data()+4,&reserved,sizeof(reserved));
+    if (!cells) return;
+    memcpy(out.data()+8,dist.data(),cells*sizeof(double));
+    memcpy(out.data()+8+cells*sizeof(double),next.data(),cells*sizeof(int32_t));
+}
+shared_ptr<AllPairsTable> AllPairsTable::fromSnapshot(shared_ptr<const MappedFile> file,const char* data,size_t size,int nodeCount) {
+    if (size<8) return nullptr;
+    uint32_t n;
+    memcpy(&n,data,sizeof(n));
+    if ((int)n!=nodeCount || n==0 || n>(uint32_t)APSP_MAX_NODES) return nullptr;
+    size_t cells=(size_t)n*n;
+    if (size!=8+cells*(sizeof(double)+sizeof(int32_t))) return nullptr;
+    const double* d=reinterpret_cast<const double*>(data+8);
+    const int32_t* nx=reinterpret_cast<const int32_t*>(data+8+cells*sizeof(double));
+    // no scan of the n^2 cells: path() checks each hop it follows
+    auto t=make_shared<AllPairsTable>();
+    t->nodeCount=(int)n;
+    t->dist.attach(file,d,cells);
+    t->next.attach(move(file),nx,cells);
+    return t;
+}
@@ -3,12 +3,16 @@
 ApiResult runOptimizerAPI(
     int mode,
     const std::vector<std::string>& locations,
-    Graph& graph
+    const std::shared_ptr<const GraphSnapshot>& snapshot,
+    const RouteOptions& options
 ) {
+    const Graph& graph=*snapshot;
     ApiResult result;
     result.success=false;
     result.totalTime=0.0;
     result.stopCount=0;
+    result.suboptimalityBound=1.0;
+    result.settledNodes=0;
     std::vector<int> ids;
     for (const auto& name:locations) {
         int id=graph.getIdByName(name);
@@ -34,12 +38,11 @@ ApiResult runOptimizerAPI(
         }
         return result;
     }
-    DSU* dsu=graph.getDSU();
-    if (dsu!=nullptr) {
-        int root=dsu->find(ids[0]);
+    if (graph.hasComponents()) {
+        int root=graph.getComponent(ids[0]);
         bool allConnected=true;
         for (int id:ids) {
-            if (dsu->find(id)!=root) {
+            if (graph.getComponent(id)!=root) {
                 allConnected=false;
                 break;
             }
@@ -51,11 +54,15 @@ ApiResult runOptimizerAPI(
     }
     bool flexible=(mode ==1);
     RouteOptimizer optimizer;
-    optimizer.setGraph(graph);
+    optimizer.setGraph(snapshot);
+    optimizer.setOptions(options);
     RouteResult r=optimizer.computeOptimalRoute(ids,flexible);
     result.success=true;
     result.algorithm=r.algorithm;
     result.totalTime=r.totalTime;
+    result.suboptimalityBound=r.suboptimalityBound;
+    result.settledNodes=r.settledNodes;
+    result.legSearch=r.legSearch;
     result.routeIds=r.attractionIds;
     result.stopCount=r.attractionIds.size();
     for (int id:r.attractionIds) {
@@ -67,13 +74,17 @@ ApiResult runOptimizerAPI(
     }
     return result;
 }
-ApiResult runFullGraphTraversal(Graph& graph) {
+ApiResult runFullGraphTraversal(const std::shared_ptr<const GraphSnapshot>& snapshot,const RouteOptions& options) {
+    const Graph& graph=*snapshot;
     ApiResult result;
     result.success=false;
     result.totalTime=0.0;
     result.stopCount=0;
+    result.suboptimalityBound=1.0;
+    result.settledNodes=0;
     RouteOptimizer optimizer;
-    optimizer.setGraph(graph);
+    optimizer.setGraph(snapshot);
+    optimizer.setOptions(options);
     RouteResult r=optimizer.computeFullGraphRoute();
     if (r.attractionIds.empty()) {
         result.errorMessage="Campus graph is not fully connected. Full traversal (Kruskal + DFS + A*) cannot be performed";
@@ -83,6 +94,9 @@ ApiResult runFullGraphTraversal(Graph& graph) {
     result.success=true;
     result.algorithm=r.algorithm;
     result.totalTime=r.totalTime;
+    result.suboptimalityBound=r.suboptimalityBound;
+    result.settledNodes=r.settledNodes;
+    result.legSearch=r.legSearch;
     result.routeIds=r.attractionIds;
     result.stopCount=r.attractionIds.size();
     for (int id:r.attractionIds) {
@@ -1,9 +1,9 @@
 #include "../include/algorithms.h"
 #include "../include/graph.h"
+#include "../include/search_workspace.h"
+#include "../include/landmarks.h"
+#include "../include/potential_search.h"
 #include <algorithm>
-#include <queue>
-#include <unordered_map>
-#include <unordered_set>
 #include <cmath>
 #include <vector>
 #ifndef M_PI
@@ -20,58 +20,50 @@ double haversine(double lat1,double lon1,double lat2,double lon2) {
     double c=2.0*atan2(sqrt(a),sqrt(1.0-a));
     return R*c*1000.0; // meters
 }
-struct AStarNode { int id; double f; };
-struct AStarCompare { bool operator()(const AStarNode& a,const AStarNode& b) const { return a.f > b.f; } };
-vector<int> aStarPath(const Graph& g,int start,int goal) {
-    // Basic A* — returns empty vector if heuristic or nodes not present or no path
+vector<int> aStarPath(const Graph& g,int start,int goal,double epsilon) {
+    // Basic A* — returns empty vector if nodes not present or no path
     if (!g.isValidAttraction(start) || !g.isValidAttraction(goal)) return {};
-        Attraction sa=g.getAttraction(start);
-        Attraction ga=g.getAttraction(goal);
-    if (sa.latitude==0 && sa.longitude==0) return {};
-    if (ga.latitude==0 && ga.longitude==0) return {};
-// Heuristic: estimate distance from current node to goal using harversine(calculates geographic distance on earth with lat,long)
-    unordered_map<int,double> gscore;
-    unordered_map<int,double> fscore;
-    unordered_map<int,int> cameFrom;
-    unordered_set<int> closed;
+    // Heuristic: great-circle distance to the goal times the graph's cheapest
+    // weight per meter (calibrated at freeze, see Graph::geometricLowerBound), so
+    // it never overestimates; without coordinates it is 0 and this is plain Dijkstra
+    // inflating a consistent heuristic by w=1+epsilon bounds the result by w
+    // times the optimum even without reopening closed nodes
+    double w=epsilon>0 ? 1.0+epsilon : 1.0;
     auto heuristic=[&](int node) {//the heuristic function(A* is dijkstra with heuristic)
-        Attraction a=g.getAttraction(node);
-        return haversine(a.latitude,a.longitude,ga.latitude,ga.longitude)/1000.0;
+        return w*g.geometricLowerBound(node,goal);
     };
-    priority_queue<AStarNode,vector<AStarNode>,AStarCompare> pq;
-    gscore[start]=0.0;
-    fscore[start]=heuristic(start);
-    pq.push({start,fscore[start]});
+    // g-scores and parents live in the thread workspace (cameFrom = parentOf),
+    // closed nodes are marked, and each node's heuristic is computed once
+    SearchWorkspace& ws=threadWorkspace();
+    ws.reset(g.maxNodeId()+1);
+    IndexedHeap<SEARCH_HEAP_ARITY>& pq=ws.heap;
+    ws.set(start,0.0,-1);
+    pq.pushOrDecrease(start,ws.potential(start,heuristic));
     while (!pq.empty()) {
-        AStarNode cur=pq.top(); pq.pop();
-        int u=cur.id;
-        if (u==goal){
-            vector<int> path;
-            int x=goal;
-            while (cameFrom.find(x)!=cameFrom.end()) {
-                path.push_back(x);
-                x=cameFrom[x];
-                }
-            path.push_back(start);
-            reverse(path.begin(),path.end());// Reconstruct the final path by walking backward from the goal to the start
-
-            return path;
-        }
-        if (closed.count(u)) continue;
-        closed.insert(u);
-        auto nbrs=g.getNeighbors(u);
-        for (size_t i=0; i<nbrs.size(); ++i) {
-            int v=nbrs[i].first;
-            double w=nbrs[i].second;
-            if (closed.count(v)) continue;
-            double tentative=gscore[u]+w;
-            if (gscore.find(v)==gscore.end() || tentative<gscore[v]) {
-                cameFrom[v]=u;
-                gscore[v]=tentative;
-                fscore[v]=tentative+heuristic(v);
-                pq.push({v,fscore[v]});
+        int u=pq.pop().second;
+        ws.countSettled();
+        // Reconstruct the final path by walking backward from the goal to the start
+        if (u==goal) return ws.pathTo(start,goal);
+        ws.mark(u); // closed
+        double du=ws.distance(u);
+        for (Neighbor nb:g.neighbors(u)) {
+            int v=nb.id;
+            if (ws.marked(v)) continue;
+            double tentative=du+nb.weight;
+            if (tentative<ws.distance(v)) {
+                ws.set(v,tentative,u);
+                pq.pushOrDecrease(v,tentative+ws.potential(v,heuristic));
             }
         }
     }
     return {};
 }
+vector<int> bidirectionalAStarPath(const Graph& g,int start,int goal) {
+    // landmark bounds are far tighter on road graphs; taking the max with the
+    // geometric one settled no fewer nodes and only cost time
+    if (const LandmarkIndex* lm=g.landmarks())
+        return altBidirectionalPath(g,*lm,start,goal,threadWorkspace(),threadReverseWorkspace()).second;
+    return bidirectionalAStarSearch(g,start,goal,threadWorkspace(),threadReverseWorkspace(),
+        [&](int v) { return g.geometricLowerBound(v,goal); },
+        [&](int v) { return g.geometricLowerBound(start,v); }).second;
+}
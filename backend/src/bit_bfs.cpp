@@ -0,0 +1,86 @@
+#include "../include/bit_bfs.h"
+#include "../include/graph.h"
+#include <algorithm>
+using namespace std;
+namespace {
+int lowestBit(uint64_t x) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(x);
+#else
+    int i=0;
+    while (!(x&1)) { x>>=1; ++i; }
+    return i;
+#endif
+}
+}
+vector<int> HopTable::path(int i,int v) const {
+    vector<int> p;
+    if (i<0 || i>=(int)sources.size() || v<0 || v>=nodeCount || hopCount(i,v)<0) return p;
+    size_t row=(size_t)i*nodeCount;
+    for (int cur=v; cur!=-1; cur=pred[row+cur]) p.push_back(cur);
+    reverse(p.begin(),p.end());
+    return p;
+}
+HopTable multiSourceBFS(const Graph& g,const vector<int>& sources,const vector<int>& targets) {
+    HopTable t;
+    int n=max(g.maxNodeId()+1,0);
+    t.nodeCount=n;
+    t.sources=sources;
+    t.hops.assign(sources.size()*n,-1);
+    t.pred.assign(sources.size()*n,-1);
+    vector<uint64_t> seen(n),frontier(n),next(n);
+    vector<int> wanted;
+    for (int v:targets) if (v>=0 && v<n) wanted.push_back(v);
+    for (size_t b=0; b<sources.size(); b+=BFS_BATCH) {
+        int count=(int)min(sources.size()-b,(size_t)BFS_BATCH);
+        uint64_t all=count==BFS_BATCH ? ~0ull : (1ull<<count)-1;
+        fill(seen.begin(),seen.end(),0);
+        fill(frontier.begin(),frontier.end(),0);
+        bool active=false;
+        uint64_t live=0; // bits of this batch's valid sources
+        for (int i=0; i<count; ++i) {
+            int s=sources[b+i];
+            if (!g.isValidAttraction(s)) continue;
+            seen[s]|=1ull<<i;
+            frontier[s]|=1ull<<i;
+            t.hops[(b+i)*n+s]=0;
+            live|=1ull<<i;
+            active=true;
+        }
+        // targets still missing a source bit; emptied ones are swapped out
+        size_t pending=wanted.size();
+        auto targetsDone=[&]() {
+            for (size_t i=0; i<pending;)
+                if ((seen[wanted[i]]&live)==live) swap(wanted[i],wanted[--pending]);
+                else ++i;
+            return !targets.empty() && pending==0;
+        };
+        for (int level=1; active && !targetsDone(); ++level) {
+            active=false;
+            // pull: v collects the batch bits of neighbours on the last level
+            // that it has not seen yet; the neighbour that brings a bit first is
+            // that source's predecessor of v
+            for (int v=0; v<n; ++v) {
+                uint64_t want=all&~seen[v];
+                uint64_t got=0;
+                for (Neighbor nb:g.neighbors(v)) {
+                    if (!want) break;
+                    uint64_t f=frontier[nb.id]&want;
+                    if (!f) continue;
+                    want&=~f;
+                    got|=f;
+                    for (; f; f&=f-1) {
+                        size_t cell=(b+lowestBit(f))*n+v;
+                        t.hops[cell]=level;
+                        t.pred[cell]=nb.id;
+                    }
+                }
+                next[v]=got;
+                if (got) active=true;
+            }
+            for (int v=0; v<n; ++v) seen[v]|=next[v];
+            frontier.swap(next);
+        }
+    }
+    return t;
+}
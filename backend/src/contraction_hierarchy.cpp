@@ -0,0 +1,326 @@
+#include "../include/contraction_hierarchy.h"
+#include "../include/graph.h"
+#include "../include/search_workspace.h"
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <queue>
+#include <thread>
+using namespace std;
+namespace {
+// Witness searches give up after this many settled nodes; a missed witness only
+// costs a superfluous shortcut, never a wrong distance.
+const int WITNESS_SETTLE_LIMIT=500;
+// After a contraction, neighbours of at most this degree are re-scored at once;
+// busier ones only get the deleted-neighbour bump and are re-scored when popped.
+// Re-simulating every neighbour made preprocessing several times slower for
+// little query gain.
+const size_t NEIGHBOR_RESCORE_DEGREE=6;
+// Remaining (uncontracted) graph during preprocessing.
+struct Contractor {
+    vector<vector<CHArc>> adj;
+    int n;
+    explicit Contractor(const Graph& g): n(g.maxNodeId()+1) {
+        adj.assign(max(n,0),{});
+        for (int u=0; u<n; ++u) {
+            int last=-1;
+            // CSR rows are sorted by (target, weight): the first of a run is the cheapest road
+            for (Neighbor nb:g.neighbors(u)) {
+                if (nb.id==last || nb.id==u || nb.id<0 || nb.id>=n) continue;
+                adj[u].push_back({nb.id,-1,nb.weight});
+                last=nb.id;
+            }
+        }
+    }
+    // Dijkstra from source in the remaining graph minus skip, up to maxDist or
+    // until the pending targets (marked in ws by the caller) are settled.
+    void witnessSearch(int source,int skip,double maxDist,int pending,SearchWorkspace& ws) const {
+        ws.set(source,0.0,-1);
+        ws.heap.pushOrDecrease(source,0.0);
+        int settled=0;
+        while (!ws.heap.empty() && pending>0) {
+            pair<double,int> top=ws.heap.pop();
+            if (top.first>maxDist || ++settled>WITNESS_SETTLE_LIMIT) break;
+            if (ws.marked(top.second)) { ws.unmark(top.second); --pending; }
+            for (const CHArc& a:adj[top.second]) {
+                if (a.target==skip) continue;
+                double nd=top.first+a.weight;
+                if (nd<ws.distance(a.target)) {
+                    ws.set(a.target,nd,top.second);
+                    ws.heap.pushOrDecrease(a.target,nd);
+                }
+            }
+        }
+    }
+    // Shortcuts contracting v would need, as (u, w, weight) with u before w in adj[v].
+    void shortcutsFor(int v,SearchWorkspace& ws,vector<CHArc>& from,vector<CHArc>& to) const {
+        from.clear();
+        to.clear();
+        const vector<CHArc>& nb=adj[v];
+        for (size_t i=0; i+1<nb.size(); ++i) {
+            double maxVia=0;
+            ws.reset(n);
+            for (size_t j=i+1; j<nb.size(); ++j) {
+                maxVia=max(maxVia,nb[i].weight+nb[j].weight);
+                ws.mark(nb[j].target);
+            }
+            witnessSearch(nb[i].target,v,maxVia,(int)(nb.size()-i-1),ws);
+            for (size_t j=i+1; j<nb.size(); ++j) {
+                double via=nb[i].weight+nb[j].weight;
+                if (ws.distance(nb[j].target)>via) {
+                    from.push_back({nb[i].target,v,via});
+                    to.push_back({nb[j].target,v,via});
+                }
+            }
+        }
+    }
+    // Edge difference plus already-contracted neighbours (spreads contraction evenly).
+    int priority(int v,int deletedNeighbors,SearchWorkspace& ws,vector<CHArc>& a,vector<CHArc>& b) const {
+        shortcutsFor(v,ws,a,b);
+        return (int)a.size()-(int)adj[v].size()+deletedNeighbors;
+    }
+    static void addOrImprove(vector<CHArc>& row,const CHArc& arc) {
+        for (CHArc& x:row) {
+            if (x.target!=arc.target) continue;
+            if (arc.weight<x.weight) x=arc;
+            return;
+        }
+        row.push_back(arc);
+    }
+    static void removeTarget(vector<CHArc>& row,int target) {
+        for (size_t i=0; i<row.size(); ++i)
+            if (row[i].target==target) { row[i]=row.back(); row.pop_back(); return; }
+    }
+};
+}
+shared_ptr<ContractionHierarchy> ContractionHierarchy::build(const Graph& g,int threads) {
+    auto ch=make_shared<ContractionHierarchy>();
+    Contractor c(g);
+    int n=c.n;
+    ch->nodeCount=max(n,0);
+    if (n<=0) return ch;
+    vector<int> prio(n),deleted(n,0);
+    // initial priorities only read the graph, so they are computed in parallel
+    if (threads<=0) threads=max(1u,thread::hardware_concurrency());
+    threads=min(threads,max(1,n/1024));
+    auto scoreRange=[&](int lo,int hi) {
+        SearchWorkspace ws;
+        vector<CHArc> a,b;
+        for (int v=lo; v<hi; ++v) prio[v]=c.priority(v,0,ws,a,b);
+    };
+    vector<thread> pool;
+    for (int t=1; t<threads; ++t) pool.emplace_back(scoreRange,(int)((long long)n*t/threads),(int)((long long)n*(t+1)/threads));
+    scoreRange(0,(int)((long long)n/threads));
+    for (thread& t:pool) t.join();
+
+    // lazy queue: a popped node is re-scored and contracted only if it is still the cheapest
+    priority_queue<pair<int,int>,vector<pair<int,int>>,greater<pair<int,int>>> pq;
+    for (int v=0; v<n; ++v) pq.push({prio[v],v});
+    vector<int> order(n,-1);
+    vector<vector<CHArc>> upward(n);
+    SearchWorkspace ws;
+    vector<CHArc> from,to;
+    int next=0;
+    while (!pq.empty()) {
+        int v=pq.top().second;
+        int p=pq.top().first;
+        pq.pop();
+        if (order[v]!=-1 || p!=prio[v]) continue; // stale entry
+        prio[v]=c.priority(v,deleted[v],ws,from,to);
+        if (!pq.empty() && prio[v]>pq.top().first) { pq.push({prio[v],v}); continue; }
+        // contract v: its remaining arcs all lead to higher-ranked nodes
+        order[v]=next++;
+        upward[v]=move(c.adj[v]);
+        c.adj[v].clear();
+        for (size_t i=0; i<from.size(); ++i) {
+            Contractor::addOrImprove(c.adj[from[i].target],{to[i].target,v,from[i].weight});
+            Contractor::addOrImprove(c.adj[to[i].target],{from[i].target,v,from[i].weight});
+        }
+        for (const CHArc& a:upward[v]) {
+            Contractor::removeTarget(c.adj[a.target],v);
+            ++deleted[a.target];
+            if (c.adj[a.target].size()<=NEIGHBOR_RESCORE_DEGREE) prio[a.target]=c.priority(a.target,deleted[a.target],ws,from,to);
+            else ++prio[a.target];
+            pq.push({prio[a.target],a.target});
+        }
+    }
+    vector<int> offsets(n+1,0);
+    vector<CHArc> arcs;
+    for (int u=0; u<n; ++u) {
+        sort(upward[u].begin(),upward[u].end(),[](const CHArc& a,const CHArc& b) { return a.target<b.target; });
+        arcs.insert(arcs.end(),upward[u].begin(),upward[u].end());
+        offsets[u+1]=(int)arcs.size();
+    }
+    ch->rank.assign(move(order));
+    ch->upOffset.assign(move(offsets));
+    ch->upArcs.assign(move(arcs));
+    return ch;
+}
+void ContractionHierarchy::upwardSearch(int source,SearchWorkspace& ws,vector<int>& settled) const {
+    ws.reset(nodeCount);
+    settled.clear();
+    if (source<0 || source>=nodeCount) return;
+    ws.set(source,0.0,-1);
+    ws.heap.pushOrDecrease(source,0.0);
+    while (!ws.heap.empty()) {
+        pair<double,int> top=ws.heap.pop();
+        if (stalled(top.second,top.first,ws)) continue;
+        settled.push_back(top.second);
+        for (const CHArc* a=upwardBegin(top.second); a!=upwardEnd(top.second); ++a) {
+            double nd=top.first+a->weight;
+            if (nd<ws.distance(a->target)) {
+                ws.set(a->target,nd,top.second);
+                ws.heap.pushOrDecrease(a->target,nd);
+            }
+        }
+    }
+}
+namespace {
+struct BucketEntry {
+    int node;
+    int target; // column in the matrix
+    double dist;
+};
+}
+vector<vector<double>> ContractionHierarchy::distanceMatrix(const vector<int>& sources,const vector<int>& targets,
+    SearchWorkspace& ws) const {
+    const double INF=numeric_limits<double>::infinity();
+    vector<vector<double>> table(sources.size(),vector<double>(targets.size(),INF));
+    vector<int> settled;
+    vector<BucketEntry> buckets;
+    for (size_t j=0; j<targets.size(); ++j) {
+        upwardSearch(targets[j],ws,settled); // undirected: the backward search is an upward one
+        for (int v:settled) buckets.push_back({v,(int)j,ws.distance(v)});
+    }
+    // one sorted array instead of a bucket list per node: nothing here is O(V)
+    sort(buckets.begin(),buckets.end(),[](const BucketEntry& a,const BucketEntry& b) { return a.node<b.node; });
+    for (size_t i=0; i<sources.size(); ++i) {
+        upwardSearch(sources[i],ws,settled);
+        vector<double>& row=table[i];
+        for (int v:settled) {
+            auto it=lower_bound(buckets.begin(),buckets.end(),v,[](const BucketEntry& e,int node) { return e.node<node; });
+            double dv=ws.distance(v);
+            for (; it!=buckets.end() && it->node==v; ++it)
+                if (dv+it->dist<row[it->target]) row[it->target]=dv+it->dist;
+        }
+    }
+    return table;
+}
+pair<double,vector<int>> ContractionHierarchy::shortestPath(int source,int target,SearchWorkspace& fwd,SearchWorkspace& bwd) const {
+    const double INF=numeric_limits<double>::infinity();
+    fwd.reset(nodeCount);
+    bwd.reset(nodeCount);
+    if (source<0 || target<0 || source>=nodeCount || target>=nodeCount) return {INF,{}};
+    if (source==target) return {0.0,{source}};
+    fwd.set(source,0.0,-1);
+    bwd.set(target,0.0,-1);
+    fwd.heap.pushOrDecrease(source,0.0);
+    bwd.heap.pushOrDecrease(target,0.0);
+    double best=INF;
+    int meet=-1;
+    // Unlike plain bidirectional Dijkstra the searches cannot stop at the first
+    // meeting: each side runs until its own frontier key reaches best.
+    for (;;) {
+        bool fOpen=!fwd.heap.empty() && fwd.heap.top().first<best;
+        bool bOpen=!bwd.heap.empty() && bwd.heap.top().first<best;
+        if (!fOpen && !bOpen) break;
+        bool forward=fOpen && (!bOpen || fwd.heap.top().first<=bwd.heap.top().first);
+        SearchWorkspace& ws=forward ? fwd : bwd;
+        SearchWorkspace& other=forward ? bwd : fwd;
+        pair<double,int> top=ws.heap.pop();
+        int u=top.second;
+        ws.countSettled();
+        if (other.reached(u) && top.first+other.distance(u)<best) {
+            best=top.first+other.distance(u);
+            meet=u;
+        }
+        if (stalled(u,top.first,ws)) continue;
+        for (const CHArc* a=upwardBegin(u); a!=upwardEnd(u); ++a) {
+            double nd=top.first+a->weight;
+            if (nd<ws.distance(a->target)) {
+                ws.set(a->target,nd,u);
+                ws.heap.pushOrDecrease(a->target,nd);
+            }
+        }
+    }
+    if (meet==-1) return {INF,{}};
+    // hierarchy path source..meet..target, then expand each arc into roads
+    vector<int> hops=fwd.pathTo(source,meet);
+    for (int x=bwd.parentOf(meet); x!=-1; x=bwd.parentOf(x)) hops.push_back(x);
+    vector<int> path{source};
+    for (size_t i=0; i+1<hops.size(); ++i) unpack(hops[i],hops[i+1],path);
+    return {best,path};
+}
+// Stall-on-demand: the graph is undirected, so an upward arc u-w is also an arc
+// into u from the higher-ranked w. If w already offers a shorter way to u, u is
+// not on a shortest up-path and need not be expanded.
+bool ContractionHierarchy::stalled(int u,double d,const SearchWorkspace& ws) const {
+    for (const CHArc* a=upwardBegin(u); a!=upwardEnd(u); ++a)
+        if (ws.distance(a->target)+a->weight<d) return true;
+    return false;
+}
+// The arc between adjacent hierarchy nodes is stored at the lower-ranked end.
+const CHArc* ContractionHierarchy::findArc(int a,int b) const {
+    int lo=rank[a]<rank[b] ? a : b;
+    int hi=lo==a ? b : a;
+    const CHArc* first=upwardBegin(lo);
+    const CHArc* last=upwardEnd(lo);
+    const CHArc* it=lower_bound(first,last,hi,[](const CHArc& x,int t) { return x.target<t; });
+    return (it!=last && it->target==hi) ? it : nullptr;
+}
+// Appends the roads of arc a-b (excluding a) to path, expanding shortcuts.
+void ContractionHierarchy::unpack(int a,int b,vector<int>& path) const {
+    vector<pair<int,int>> stack{{a,b}};
+    while (!stack.empty()) {
+        pair<int,int> e=stack.back();
+        stack.pop_back();
+        const CHArc* arc=findArc(e.first,e.second);
+        if (!arc || arc->middle<0) { path.push_back(e.second); continue; }
+        // second half is pushed first so the first half is expanded first
+        stack.push_back({arc->middle,e.second});
+        stack.push_back({e.first,arc->middle});
+    }
+}
+// Section layout: uint32 nodeCount, uint32 arcCount, int32 rank[nodeCount],
+// int32 upOffset[nodeCount+1], padding to 8 bytes, CHArc arcs[arcCount].
+static size_t hierarchyArcOffset(uint32_t n) {
+    return ((2+2*(size_t)n+1)*sizeof(int32_t)+7)&~(size_t)7;
+}
+void ContractionHierarchy::serialize(vector<char>& out) const {
+    uint32_t n=(uint32_t)nodeCount,m=(uint32_t)upArcs.size();
+    size_t off=hierarchyArcOffset(n);
+    out.assign(off+(size_t)m*sizeof(CHArc),0);
+    memcpy(out.data(),&n,sizeof(n));
+    memcpy(out.data()+4,&m,sizeof(m));
+    if (n==0) return;
+    memcpy(out.data()+8,rank.data(),n*sizeof(int32_t));
+    memcpy(out.data()+8+4*(size_t)n,upOffset.data(),(n+1)*sizeof(int32_t));
+    if (m) memcpy(out.data()+off,upArcs.data(),(size_t)m*sizeof(CHArc));
+}
+shared_ptr<ContractionHierarchy> ContractionHierarchy::fromSnapshot(shared_ptr<const MappedFile> file,const char* data,size_t size,int nodeCount) {
+    if (size<8) return nullptr;
+    uint32_t n,m;
+    memcpy(&n,data,sizeof(n));
+    memcpy(&m,data+4,sizeof(m));
+    if ((int)n!=nodeCount || n==0) return nullptr;
+    size_t off=hierarchyArcOffset(n);
+    if (size!=off+(size_t)m*sizeof(CHArc)) return nullptr;
+    const int* ranks=reinterpret_cast<const int*>(data+8);
+    const int* offsets=reinterpret_cast<const int*>(data+8+4*(size_t)n);
+    const CHArc* arcs=reinterpret_cast<const CHArc*>(data+off);
+    // same structural checks as the CSR sections: no query may leave the arrays
+    if (offsets[0]!=0 || (uint32_t)offsets[n]!=m) return nullptr;
+    for (uint32_t i=0; i<n; ++i) {
+        if (offsets[i]>offsets[i+1] || ranks[i]<0 || (uint32_t)ranks[i]>=n) return nullptr;
+    }
+    for (uint32_t e=0; e<m; ++e) {
+        const CHArc& a=arcs[e];
+        if (a.target<0 || (uint32_t)a.target>=n || a.middle<-1 || a.middle>=(int32_t)n || !(a.weight>=0)) return nullptr;
+    }
+    auto ch=make_shared<ContractionHierarchy>();
+    ch->nodeCount=(int)n;
+    ch->rank.attach(file,ranks,n);
+    ch->upOffset.attach(file,offsets,n+1);
+    ch->upArcs.attach(move(file),arcs,m);
+    return ch;
+}
@@ -0,0 +1,169 @@
+#include "../include/csv_import.h"
+#include "../include/graph.h"
+#include "../include/mapped_file.h"
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string_view>
+#include <thread>
+#include <vector>
+using namespace std;
+namespace {
+const size_t MIN_CHUNK_BYTES=1<<16; // below this a thread costs more than it parses
+struct Chunk {
+    const char* begin;
+    const char* end;
+};
+struct RoadRow {
+    int from, to;
+    double weight;
+};
+// Skips the header line, then cuts the rest into at most `parts` pieces that
+// each end just after a newline.
+vector<Chunk> splitLines(const char* data,size_t size,int parts) {
+    vector<Chunk> chunks;
+    const char* end=data+size;
+    const char* p=static_cast<const char*>(memchr(data,'\n',size));
+    if (!p) return chunks;
+    ++p;
+    size_t body=end-p;
+    int want=max(1,min(parts,(int)(body/MIN_CHUNK_BYTES)+1));
+    size_t step=body/want+1;
+    while (p<end) {
+        const char* cut=p+min(step,(size_t)(end-p));
+        if (cut<end) {
+            const char* nl=static_cast<const char*>(memchr(cut,'\n',end-cut));
+            cut=nl ? nl+1 : end;
+        }
+        chunks.push_back({p,cut});
+        p=cut;
+    }
+    return chunks;
+}
+// Calls fn(fields, count) for each non-empty line; fields beyond `maxFields` are dropped.
+template <typename Fn>
+void forEachRow(const Chunk& c,string_view* fields,int maxFields,Fn fn) {
+    const char* p=c.begin;
+    while (p<c.end) {
+        const char* nl=static_cast<const char*>(memchr(p,'\n',c.end-p));
+        const char* lineEnd=nl ? nl : c.end;
+        const char* next=nl ? nl+1 : c.end;
+        if (lineEnd>p && lineEnd[-1]=='\r') --lineEnd;
+        if (lineEnd>p) {
+            int count=0;
+            const char* f=p;
+            while (count<maxFields) {
+                const char* comma=static_cast<const char*>(memchr(f,',',lineEnd-f));
+                const char* fEnd=comma ? comma : lineEnd;
+                fields[count++]=string_view(f,fEnd-f);
+                if (!comma) break;
+                f=comma+1;
+            }
+            for (int i=count; i<maxFields; ++i) fields[i]=string_view();
+            fn(fields,count);
+        }
+        p=next;
+    }
+}
+string_view trim(string_view s) {
+    while (!s.empty() && (s.front()==' ' || s.front()=='\t')) s.remove_prefix(1);
+    while (!s.empty() && (s.back()==' ' || s.back()=='\t')) s.remove_suffix(1);
+    return s;
+}
+// Leaves `out` untouched on an empty field; counts a malformed one.
+template <typename T>
+void parseField(string_view s,T& out,long long& malformed) {
+    s=trim(s);
+    if (s.empty()) return;
+    if (s.front()=='+') s.remove_prefix(1);
+    T v;
+    auto r=from_chars(s.data(),s.data()+s.size(),v);
+    if (r.ec==errc()) out=v;
+    else ++malformed;
+}
+template <typename Fn>
+void runParallel(size_t jobs,Fn fn) {
+    if (jobs<=1) {
+        for (size_t i=0; i<jobs; ++i) fn(i);
+        return;
+    }
+    vector<thread> pool;
+    pool.reserve(jobs);
+    for (size_t i=0; i<jobs; ++i) pool.emplace_back(fn,i);
+    for (auto& t:pool) t.join();
+}
+}
+ImportStats importGraphCSV(Graph& g,const string& attractionsFile,const string& roadsFile,int threads) {
+    ImportStats stats;
+    auto t0=chrono::steady_clock::now();
+    if (threads<=0) threads=max(1u,thread::hardware_concurrency());
+    MappedFile af;
+    if (!af.open(attractionsFile)) {
+        cerr<<"[graph] cannot open attractions file: "<<attractionsFile<<"\n";
+        return stats;
+    }
+    vector<Chunk> achunks=splitLines(af.data(),af.size(),threads);
+    stats.threads=max(1,(int)achunks.size());
+    vector<vector<Attraction>> parsed(achunks.size());
+    vector<long long> amalformed(achunks.size(),0);
+    runParallel(achunks.size(),[&](size_t c) {
+        string_view f[8];
+        forEachRow(achunks[c],f,8,[&](string_view* fields,int) {
+            Attraction at;
+            at.name.assign(fields[0]);
+            at.category.assign(fields[1]);
+            long long& bad=amalformed[c];
+            parseField(fields[2],at.rating,bad);
+            parseField(fields[3],at.visitDuration,bad);
+            parseField(fields[4],at.entryFee,bad);
+            parseField(fields[5],at.popularity,bad);
+            parseField(fields[6],at.latitude,bad);
+            parseField(fields[7],at.longitude,bad);
+            parsed[c].push_back(move(at));
+        });
+    });
+    // IDs follow file order, exactly as the sequential loader assigned them;
+    // this also fills the graph's name index that the road workers read
+    int nextId=g.size();
+    for (size_t c=0; c<parsed.size(); ++c) {
+        for (Attraction& at:parsed[c]) {
+            at.id=nextId++;
+            g.addAttraction(at);
+        }
+        stats.attractionRows+=(long long)parsed[c].size();
+        stats.malformedFields+=amalformed[c];
+    }
+    MappedFile rf;
+    if (!rf.open(roadsFile)) {
+        cerr<<"[graph] cannot open roads file: "<<roadsFile<<"\n";
+    } else {
+        vector<Chunk> rchunks=splitLines(rf.data(),rf.size(),threads);
+        stats.threads=max(stats.threads,(int)rchunks.size());
+        vector<vector<RoadRow>> roads(rchunks.size());
+        vector<long long> rrows(rchunks.size(),0),rrejected(rchunks.size(),0),rmalformed(rchunks.size(),0);
+        runParallel(rchunks.size(),[&](size_t c) {
+            string_view f[3];
+            forEachRow(rchunks[c],f,3,[&](string_view* fields,int) {
+                ++rrows[c];
+                int u=g.getIdByName(fields[0]);
+                int v=g.getIdByName(fields[1]);
+                double w=1.0;
+                parseField(fields[2],w,rmalformed[c]);
+                if (u==-1 || v==-1) { ++rrejected[c]; return; }
+                roads[c].push_back({u,v,w});
+            });
+        });
+        for (size_t c=0; c<roads.size(); ++c) {
+            for (const RoadRow& r:roads[c]) g.addEdge(r.from,r.to,r.weight);
+            stats.roadRows+=rrows[c];
+            stats.rejectedRows+=rrejected[c];
+            stats.malformedFields+=rmalformed[c];
+        }
+    }
+    g.freeze();
+    g.buildDSU();
+    stats.seconds=chrono::duration<double>(chrono::steady_clock::now()-t0).count();
+    return stats;
+}
@@ -1,66 +1,220 @@
 #include "../include/algorithms.h"
 #include "../include/graph.h"
-#include <queue>
+#include "../include/search_workspace.h"
+#include "../include/landmarks.h"
+#include "../include/contraction_hierarchy.h"
+#include "../include/hub_labels.h"
+#include "../include/all_pairs.h"
+#include "../include/bit_bfs.h"
 #include <vector>
 #include <limits>
 #include <algorithm>
+#include <cmath>
+#include <cstdint>
 using namespace std;
-vector<double> dijkstra(const Graph& g,int start) {
-    int maxId=g.maxNodeId();
-    int n=maxId+1;
-    if (n<=0) return vector<double>();
-    vector<double> dist(n,numeric_limits<double>::infinity());
-    typedef pair<double,int> P;
-    priority_queue<P,vector<P>,greater<P>> pq;
-    if (!g.isValidAttraction(start)) return dist;
-    dist[start]=0.0;
-    pq.push(P(0.0,start));
+namespace {
+// Integer graphs whose largest scaled weight is at most this use Dial's buckets,
+// heavier ones the radix heap.
+const uint32_t DIAL_MAX_WEIGHT=1024;
+// Up to this many nodes the bit-parallel BFS answers uniform-weight matrices
+// faster than one bounded search per source (measured on grids, 5-64 sources).
+const int BFS_MATRIX_MAX_NODES=1024;
+// Each runner calls settle(u) once per settled node, in distance order, and
+// stops early when it returns false. Callers must ws.reset() first.
+template <typename Settle>
+void runHeapSearch(const Graph& g,int source,SearchWorkspace& ws,Settle settle) {
+    int n=g.maxNodeId()+1;
+    IndexedHeap<SEARCH_HEAP_ARITY>& pq=ws.heap;
+    ws.set(source,0.0,-1);
+    pq.pushOrDecrease(source,0.0);
     while (!pq.empty()) {
-        P top=pq.top(); pq.pop();
+        pair<double,int> top=pq.pop(); // settled: decrease-key leaves no stale entries
         double d=top.first;
         int u=top.second;
-        if (d>dist[u]) continue;
-        auto nbrs=g.getNeighbors(u);
-        for (size_t i=0; i<nbrs.size(); ++i) {
-            int v=nbrs[i].first;
-            double w=nbrs[i].second;
-            if (v<0 || v>=(int)dist.size()) continue;
-            if (dist[v]>d+w) {
-                dist[v]=d+w;
-                pq.push(P(dist[v],v));
+        if (!settle(u)) return;
+        for (Neighbor nb:g.neighbors(u)) {
+            int v=nb.id;
+            if (v<0 || v>=n) continue;
+            if (ws.distance(v)>d+nb.weight) {
+                ws.set(v,d+nb.weight,u);
+                pq.pushOrDecrease(v,d+nb.weight);
             }
         }
     }
-    return dist;
 }
-pair<vector<double>,vector<int>> dijkstraWithPath(const Graph& g,int start) {
-    int maxId=g.maxNodeId();
-    int n=maxId+1;
-    if (n<=0) return {vector<double>(),vector<int>()};
-    vector<double> dist(n,numeric_limits<double>::infinity());
-    vector<int> parent(n,-1);
-    typedef pair<double,int> P;
-    priority_queue<P,vector<P>,greater<P>> pq;
-    if (!g.isValidAttraction(start)) return {dist,parent};
-    dist[start]=0.0;
-    pq.push(P(0.0,start));
-    while (!pq.empty()) {
-        P top=pq.top(); pq.pop();
+// Same search on the scaled integer weights: keys are exact, and the workspace
+// stores them divided back by the scale.
+template <typename Queue,typename Settle>
+void runIntegerSearch(const Graph& g,int source,SearchWorkspace& ws,Queue& q,Settle settle) {
+    int n=g.maxNodeId()+1;
+    double scale=g.integerWeightScale();
+    auto scaledDist=[&](int v) {
+        return ws.reached(v) ? (uint64_t)llround(ws.distance(v)*scale) : UINT64_MAX;
+    };
+    ws.set(source,0.0,-1);
+    q.push(0,source);
+    while (!q.empty()) {
+        pair<uint64_t,int> top=q.pop();
+        uint64_t d=top.first;
+        int u=top.second;
+        if (d!=scaledDist(u)) continue; // stale entry
+        if (!settle(u)) return;
+        const uint32_t* w=g.intWeightsOf(u);
+        int i=0;
+        for (Neighbor nb:g.neighbors(u)) {
+            int v=nb.id;
+            uint64_t nd=d+w[i++];
+            if (v<0 || v>=n) continue;
+            if (scaledDist(v)>nd) {
+                ws.set(v,nd/scale,u);
+                q.push(nd,v);
+            }
+        }
+    }
+}
+template <typename Settle>
+void runSearch(const Graph& g,int source,SearchWorkspace& ws,Settle settle) {
+    if (!g.hasIntegerWeights()) {
+        runHeapSearch(g,source,ws,settle);
+    } else if (g.maxIntegerWeight()<=DIAL_MAX_WEIGHT) {
+        ws.dial.reset(g.maxIntegerWeight());
+        runIntegerSearch(g,source,ws,ws.dial,settle);
+    } else {
+        ws.radix.reset();
+        runIntegerSearch(g,source,ws,ws.radix,settle);
+    }
+}
+}
+void dijkstraSearch(const Graph& g,int start,SearchWorkspace& ws) {
+    ws.reset(g.maxNodeId()+1);
+    if (!g.isValidAttraction(start)) return;
+    runSearch(g,start,ws,[](int) { return true; });
+}
+vector<double> dijkstraToTargets(const Graph& g,int source,const vector<int>& targets,SearchWorkspace& ws) {
+    const double INF=numeric_limits<double>::infinity();
+    int n=g.maxNodeId()+1;
+    ws.reset(n);
+    vector<double> row(targets.size(),INF);
+    if (!g.isValidAttraction(source)) return row;
+    int pending=0;
+    for (int t:targets) {
+        if (t<0 || t>=n || ws.marked(t)) continue;
+        ws.mark(t);
+        ++pending;
+    }
+    runSearch(g,source,ws,[&](int u) {
+        // u is settled: its distance is final
+        if (ws.marked(u)) { ws.unmark(u); --pending; }
+        return pending>0;
+    });
+    for (size_t i=0; i<targets.size(); ++i) {
+        int t=targets[i];
+        if (t>=0 && t<n) row[i]=ws.distance(t);
+    }
+    return row;
+}
+pair<double,vector<int>> bidirectionalDijkstra(const Graph& g,int source,int target,SearchWorkspace& fwd,SearchWorkspace& bwd) {
+    const double INF=numeric_limits<double>::infinity();
+    int n=g.maxNodeId()+1;
+    fwd.reset(n);
+    bwd.reset(n);
+    if (!g.isValidAttraction(source) || !g.isValidAttraction(target)) return {INF,{}};
+    if (source==target) return {0.0,{source}};
+    fwd.set(source,0.0,-1);
+    bwd.set(target,0.0,-1);
+    fwd.heap.pushOrDecrease(source,0.0);
+    bwd.heap.pushOrDecrease(target,0.0);
+    double best=INF; // length of the best s-t path seen so far
+    int meet=-1;
+    while (!fwd.heap.empty() && !bwd.heap.empty()) {
+        // no unsettled node can lie on a path shorter than best any more
+        if (fwd.heap.top().first+bwd.heap.top().first>=best) break;
+        // expand the side with the smaller frontier key
+        bool forward=fwd.heap.top().first<=bwd.heap.top().first;
+        SearchWorkspace& ws=forward ? fwd : bwd;
+        SearchWorkspace& other=forward ? bwd : fwd;
+        pair<double,int> top=ws.heap.pop();
         double d=top.first;
         int u=top.second;
-        if (d>dist[u]) continue;
-        auto nbrs=g.getNeighbors(u);
-        for (size_t i=0; i<nbrs.size(); ++i) {
-            int v=nbrs[i].first;
-            double w=nbrs[i].second;
-            if (v<0 || v>=(int)dist.size()) continue;
-            if (dist[v]>d+w) {
-                dist[v]=d+w;
-                parent[v]=u;
-                pq.push(P(dist[v],v));
+        for (Neighbor nb:g.neighbors(u)) {
+            int v=nb.id;
+            if (v<0 || v>=n) continue;
+            double nd=d+nb.weight;
+            if (ws.distance(v)>nd) {
+                ws.set(v,nd,u);
+                ws.heap.pushOrDecrease(v,nd);
+            }
+            if (other.reached(v) && nd+other.distance(v)<best) {
+                best=nd+other.distance(v);
+                meet=v;
             }
         }
     }
+    if (meet==-1) return {INF,{}};
+    // source..meet from the forward tree, then meet..target from the backward one
+    vector<int> path=fwd.pathTo(source,meet);
+    for (int x=bwd.parentOf(meet); x!=-1; x=bwd.parentOf(x)) path.push_back(x);
+    return {best,path};
+}
+pair<double,vector<int>> shortestPath(const Graph& g,int source,int target) {
+    if (const AllPairsTable* ap=g.allPairs()) {
+        double d=ap->distance(source,target);
+        if (d==numeric_limits<double>::infinity()) return {d,{}};
+        return {d,ap->path(source,target)};
+    }
+    if (const ContractionHierarchy* ch=g.contractionHierarchy())
+        return ch->shortestPath(source,target,threadWorkspace(),threadReverseWorkspace());
+    // one-directional ALT: its bounds are tighter than the averaged ones the
+    // bidirectional variant must use, and it measured slightly faster
+    if (const LandmarkIndex* lm=g.landmarks()) return altPath(g,*lm,source,target,threadWorkspace());
+    return bidirectionalDijkstra(g,source,target,threadWorkspace(),threadReverseWorkspace());
+}
+vector<vector<double>> distanceMatrix(const Graph& g,const vector<int>& sources,const vector<int>& targets) {
+    SearchWorkspace& ws=threadWorkspace();
+    if (const AllPairsTable* ap=g.allPairs()) return ap->distanceMatrix(sources,targets);
+    if (const HubLabels* hl=g.hubLabelIndex()) return hl->distanceMatrix(sources,targets);
+    if (const ContractionHierarchy* ch=g.contractionHierarchy()) return ch->distanceMatrix(sources,targets,ws);
+    // hop counts are distances on uniform weights, but the bit-parallel BFS
+    // sweeps every node per level and fills sources x V tables: it beats the
+    // target-bounded searches only on small graphs or when the targets are
+    // most of the graph
+    int n=g.maxNodeId()+1;
+    if (g.hasUniformWeights() && (n<=BFS_MATRIX_MAX_NODES || 2*targets.size()>=(size_t)n)) {
+        HopTable h=multiSourceBFS(g,sources,targets);
+        vector<vector<double>> table(sources.size(),vector<double>(targets.size(),numeric_limits<double>::infinity()));
+        for (size_t i=0; i<sources.size(); ++i)
+            for (size_t j=0; j<targets.size(); ++j) {
+                int t=targets[j];
+                int hops=(t>=0 && t<h.nodeCount) ? h.hopCount((int)i,t) : -1;
+                if (hops>=0) table[i][j]=hops*g.uniformWeight();
+            }
+        return table;
+    }
+    vector<vector<double>> table(sources.size());
+    // each search stops as soon as every target is settled
+    for (size_t i=0; i<sources.size(); ++i) table[i]=dijkstraToTargets(g,sources[i],targets,ws);
+    return table;
+}
+vector<double> dijkstra(const Graph& g,int start) {
+    int n=g.maxNodeId()+1;
+    if (n<=0) return vector<double>();
+    SearchWorkspace& ws=threadWorkspace();
+    dijkstraSearch(g,start,ws);
+    vector<double> dist(n);
+    for (int v=0; v<n; ++v) dist[v]=ws.distance(v);
+    return dist;
+}
+pair<vector<double>,vector<int>> dijkstraWithPath(const Graph& g,int start) {
+    int n=g.maxNodeId()+1;
+    if (n<=0) return {vector<double>(),vector<int>()};
+    SearchWorkspace& ws=threadWorkspace();
+    dijkstraSearch(g,start,ws);
+    vector<double> dist(n);
+    vector<int> parent(n);
+    for (int v=0; v<n; ++v) {
+        dist[v]=ws.distance(v);
+        parent[v]=ws.parentOf(v);
+    }
     return {dist,parent};
 }
 vector<int> reconstructPath(const vector<int>& parent,int start,int end) {
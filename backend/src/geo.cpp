@@ -0,0 +1,94 @@
+#include "../include/geo.h"
+#include "../include/graph.h"
+#include <algorithm>
+#include <limits>
+using namespace std;
+namespace {
+const double DEG_TO_RAD=3.14159265358979323846/180.0;
+}
+void GeoPoints::assign(const double* latLonDegrees,size_t n) {
+    vector<double> la(n),lo(n),c(n),px(n),py(n),pz(n);
+    for (size_t i=0; i<n; ++i) {
+        la[i]=latLonDegrees[2*i]*DEG_TO_RAD;
+        lo[i]=latLonDegrees[2*i+1]*DEG_TO_RAD;
+        c[i]=cos(la[i]);
+        px[i]=c[i]*cos(lo[i]);
+        py[i]=c[i]*sin(lo[i]);
+        pz[i]=sin(la[i]);
+    }
+    lat.assign(move(la));
+    lon.assign(move(lo));
+    cosLat.assign(move(c));
+    x.assign(move(px));
+    y.assign(move(py));
+    z.assign(move(pz));
+}
+void GeoPoints::attach(shared_ptr<const MappedFile> file,const double* fields,size_t n) {
+    lat.attach(file,fields,n);
+    lon.attach(file,fields+n,n);
+    cosLat.attach(file,fields+2*n,n);
+    x.attach(file,fields+3*n,n);
+    y.attach(file,fields+4*n,n);
+    z.attach(file,fields+5*n,n);
+}
+void greatCircleBatch(double latDeg,double lonDeg,const GeoPoints& p,double* out) {
+    double la=latDeg*DEG_TO_RAD,lo=lonDeg*DEG_TO_RAD;
+    double qx=cos(la)*cos(lo),qy=cos(la)*sin(lo),qz=sin(la);
+    size_t n=p.size();
+    const double* px=p.x.data();
+    const double* py=p.y.data();
+    const double* pz=p.z.data();
+    // pass 1, vectorizable: half chord lengths
+    for (size_t i=0; i<n; ++i) {
+        double dx=px[i]-qx,dy=py[i]-qy,dz=pz[i]-qz;
+        double half=0.5*sqrt(dx*dx+dy*dy+dz*dz);
+        out[i]=half<1.0 ? half : 1.0;
+    }
+    // pass 2: the one transcendental per element
+    for (size_t i=0; i<n; ++i) out[i]=2.0*EARTH_RADIUS_M*asin(out[i]);
+}
+void equirectangularBatch(double latDeg,double lonDeg,const GeoPoints& p,double* out) {
+    double la=latDeg*DEG_TO_RAD,lo=lonDeg*DEG_TO_RAD,c=cos(la);
+    size_t n=p.size();
+    const double* plat=p.lat.data();
+    const double* plon=p.lon.data();
+    const double* pcos=p.cosLat.data();
+    for (size_t i=0; i<n; ++i) {
+        double dx=(plon[i]-lo)*0.5*(c+pcos[i]);
+        double dy=plat[i]-la;
+        out[i]=EARTH_RADIUS_M*sqrt(dx*dx+dy*dy);
+    }
+}
+vector<vector<double>> greatCircleMatrix(const GeoPoints& p,const vector<int>& rows,const vector<int>& cols) {
+    // gather the columns once so each row is one streaming pass
+    size_t m=cols.size();
+    vector<double> cx(m),cy(m),cz(m);
+    for (size_t j=0; j<m; ++j) { cx[j]=p.x[cols[j]]; cy[j]=p.y[cols[j]]; cz[j]=p.z[cols[j]]; }
+    vector<vector<double>> table(rows.size(),vector<double>(m));
+    for (size_t i=0; i<rows.size(); ++i) {
+        double qx=p.x[rows[i]],qy=p.y[rows[i]],qz=p.z[rows[i]];
+        double* out=table[i].data();
+        for (size_t j=0; j<m; ++j) {
+            double dx=cx[j]-qx,dy=cy[j]-qy,dz=cz[j]-qz;
+            double half=0.5*sqrt(dx*dx+dy*dy+dz*dz);
+            out[j]=half<1.0 ? half : 1.0;
+        }
+        for (size_t j=0; j<m; ++j) out[j]=2.0*EARTH_RADIUS_M*asin(out[j]);
+    }
+    return table;
+}
+int nearestNode(const Graph& g,double latDeg,double lonDeg) {
+    const GeoPoints& p=g.geoPoints();
+    // chord length is monotone in great-circle distance: no asin needed
+    double la=latDeg*DEG_TO_RAD,lo=lonDeg*DEG_TO_RAD;
+    double qx=cos(la)*cos(lo),qy=cos(la)*sin(lo),qz=sin(la);
+    int best=-1;
+    double bestChord=numeric_limits<double>::infinity();
+    for (int i=0; i<(int)p.size(); ++i) {
+        if (!g.hasCoordinates(i)) continue;
+        double dx=p.x[i]-qx,dy=p.y[i]-qy,dz=p.z[i]-qz;
+        double c=dx*dx+dy*dy+dz*dz;
+        if (c<bestChord) { bestChord=c; best=i; }
+    }
+    return best;
+}
@@ -1,173 +1,325 @@
 #include "../include/graph.h"
-#include <fstream>
-#include <sstream>
+#include "../include/csv_import.h"
+#include "../include/dsu.h"
+#include "../include/landmarks.h"
+#include "../include/contraction_hierarchy.h"
+#include "../include/hub_labels.h"
+#include "../include/all_pairs.h"
 #include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <limits>
-#include "../include/algorithms.h" // for Edge type in getAllEdges
 using namespace std;
-Graph::Graph():numVertices(0),dsu(nullptr) {}
-Graph::~Graph() { if (dsu) delete dsu; }
-void Graph::addAttraction(const Attraction& attr) {
-    attractions[attr.id]=attr;
-    if (!attr.name.empty()) nameToId[attr.name]=attr.id;
-    if (adjList.find(attr.id)==adjList.end())
-        adjList[attr.id]=vector<pair<int,double>>();
-    numVertices=(int)attractions.size();
+Graph::Graph():numVertices(0),weightScale(0),maxIntWeight(0),uniformWeightValue(0),geoCostPerMeter(0),frozen(false) {}
+int Graph::addAttraction(const Attraction& attr) {
+    int id;
+    thaw(); // every path below unfreezes, so adjList must exist again
+    auto it=externalToDense.find(attr.id);
+    if (it!=externalToDense.end()) {
+        id=it->second;
+        const string& oldName=attractions[id].name;
+        if (nameToId.find(oldName)==id) nameToId.erase(oldName);
+    } else {
+        dropDerivedIndexes();
+        id=numVertices++;
+        externalToDense[attr.id]=id;
+        denseToExternal.push_back(attr.id);
+        attractions.emplace_back();
+        adjList.emplace_back();
+    }
+    attractions[id]=attr;
+    attractions[id].id=id;
+    if (!attr.name.empty()) nameToId.insert(attr.name,id);
+    frozen=false;
+    return id;
 }
 void Graph::addEdge(int from,int to,double weight) {
     if (from==to) return;
-    if (adjList.find(from)==adjList.end()) adjList[from]={};
-    if (adjList.find(to)==adjList.end()) adjList[to]={};
+    if (!hasAttraction(from) || !hasAttraction(to)) return;
+    thaw();
+    dropDerivedIndexes();
     adjList[from].push_back({to,weight});
     adjList[to].push_back({from,weight});
+    frozen=false;
 }
 vector<pair<int,double>> Graph::getNeighbors(int nodeId) const {
-    auto it=adjList.find(nodeId);
-    if (it==adjList.end()) return {};
-    return it->second;
+    if (!hasAttraction(nodeId)) return {};
+    if (!frozen) return adjList[nodeId];
+    vector<pair<int,double>> out;
+    out.reserve(neighbors(nodeId).size());
+    for (Neighbor nb:neighbors(nodeId)) out.push_back({nb.id,nb.weight});
+    return out;
 }
 Attraction Graph::getAttraction(int id) const {
-    auto it=attractions.find(id);
-    if (it==attractions.end()) return Attraction();
-    return it->second;
+    if (!hasAttraction(id)) return Attraction();
+    return attractions[id];
 }
 double Graph::getEdgeWeight(int from,int to) const {
-    auto it=adjList.find(from);
-    if (it==adjList.end()) return numeric_limits<double>::infinity();
-    for (auto &p:it->second) if (p.first==to) return p.second;
-    return numeric_limits<double>::infinity();
+    if (!hasAttraction(from)) return numeric_limits<double>::infinity();
+    if (frozen) {
+        const int* b=csrTarget.data()+csrOffset[from];
+        const int* e=csrTarget.data()+csrOffset[from+1];
+        const int* it=lower_bound(b,e,to);
+        if (it==e || *it!=to) return numeric_limits<double>::infinity();
+        return csrWeight[it-csrTarget.data()];
+    }
+    double best=numeric_limits<double>::infinity();
+    for (auto &p:adjList[from]) if (p.first==to && p.second<best) best=p.second;
+    return best;
+}
+bool Graph::hasEdge(int from,int to) const {
+    return getEdgeWeight(from,to)!=numeric_limits<double>::infinity();
+}
+double Graph::pathCost(const vector<int>& path) const {
+    double total=0;
+    for (size_t i=0; i+1<path.size(); ++i) total+=getEdgeWeight(path[i],path[i+1]);
+    return total;
 }
 vector<int> Graph::getAllAttractionIds() const {
-    vector<int> ids;
-    ids.reserve(attractions.size());
-    for (auto &kv:attractions) ids.push_back(kv.first);
+    vector<int> ids(numVertices);
+    for (int i=0; i<numVertices; ++i) ids[i]=i;
     return ids;
 }
 bool Graph::hasAttraction(int id) const {
-    return attractions.find(id) != attractions.end();
+    return id>=0 && id<numVertices;
 }
-int Graph::getIdByName(const string& name) const {
-    auto it=nameToId.find(name);
-    if (it==nameToId.end()) return -1;
+int Graph::denseId(int externalId) const {
+    auto it=externalToDense.find(externalId);
+    if (it==externalToDense.end()) return -1;
     return it->second;
 }
-int Graph::maxNodeId() const {
-    int maxId=-1;
-    for (auto &kv:attractions) if (kv.first > maxId) maxId=kv.first;
-    for (auto &kv:adjList) {
-        if (kv.first > maxId) maxId=kv.first;
-        for (auto &p:kv.second) if (p.first > maxId) maxId=p.first;
-    }
-    return maxId;
+int Graph::externalId(int id) const {
+    if (!hasAttraction(id)) return -1;
+    return denseToExternal[id];
 }
 bool Graph::isValidAttraction(int id) const {
     return hasAttraction(id);
 }
 bool Graph::isFullyConnected() const {
-    if (!dsu) return false;
+    if (component.empty()) return false;
     auto ids=getAllAttractionIds();
     if (ids.empty()) return false;
-    int root=dsu->find(ids[0]);
-    for (int id:ids) if (dsu->find(id) != root) return false;
+    int root=getComponent(ids[0]);
+    for (int id:ids) if (getComponent(id) != root) return false;
     return true;
 }
 void Graph::buildDSU() {
-    if (dsu) { delete dsu; dsu=nullptr; }
+    component.clear();
     int maxId=maxNodeId();
     if (maxId < 0) return;
-    dsu=new DSU(maxId+1);
-    for (auto &kv:adjList) {
-        int u=kv.first;
-        for (auto &p:kv.second) {
-            int v=p.first;
-            if (v >= 0) dsu->unite(u,v);
+    DSU dsu(maxId+1);
+    if (!frozen) freeze();
+    for (int u=0; u<=maxId; ++u) {
+        for (Neighbor nb:neighbors(u)) {
+            if (nb.id >= 0) dsu.unite(u,nb.id);
             }
         }
+    vector<int> roots(maxId+1);
+    for (int u=0; u<=maxId; ++u) roots[u]=dsu.find(u);
+    component.assign(move(roots));
 }
-// CSV loader expecting attractions.csv header: name,category,rating,duration,fee,popularity,latitude,longitude
-// and roads.csv header: from,to,time (names)
-void Graph::loadFromCSV(const string& attractionsFile,const string& roadsFile) {
-    attractions.clear();
-    adjList.clear();
-    nameToId.clear();
-    //above 3 lines are required to CLEAR any
-    //old stored nodes/adj lists from prior,so cleared every single time(important)
-    numVertices=0;
-    if (dsu) { delete dsu; dsu=nullptr; }
-    ifstream aif(attractionsFile);
-    if (!aif.is_open()) {
-        cerr<<"[graph] cannot open attractions file: "<<attractionsFile<<"\n";
+void Graph::freeze() {
+    int n=maxNodeId()+1;
+    thaw(); // a graph mapped from a snapshot has no adjacency lists yet
+    buildCoordinates();
+    if (n<=0) {
+        csrOffset.assign(vector<int>(1,0));
+        csrTarget.clear();
+        csrWeight.clear();
+        edgeList.clear();
+        chooseWeightMode();
+        calibrateGeoBound();
+        frozen=true;
         return;
     }
-    //catches error just in case file cannot be opened
-    string line;
-    // read header
-    if (!getline(aif,line)) { aif.close(); return; }
-    int nextId=0;
-    while (getline(aif,line)) {
-        if (line.empty()) continue;
-        stringstream ss(line);
-        Attraction at;
-        at.id=nextId++;
-        string latS,lonS,ratingS,durationS,feeS,popS;
-        getline(ss,at.name,',');
-        getline(ss,at.category,',');
-        getline(ss,ratingS,',');
-        getline(ss,durationS,',');
-        getline(ss,feeS,',');
-        getline(ss,popS,',');
-        getline(ss,latS,',');
-        getline(ss,lonS,',');
-        try {
-            if (!ratingS.empty()) at.rating=stod(ratingS);
-            if (!durationS.empty()) at.visitDuration=stod(durationS);
-            if (!feeS.empty()) at.entryFee=stod(feeS);
-            if (!popS.empty()) at.popularity=stoi(popS);
-            if (!latS.empty()) at.latitude=stod(latS);
-            if (!lonS.empty()) at.longitude=stod(lonS);
-        } catch (...) { /* ignore parse errors */ }
-        addAttraction(at);
+    vector<int> offset(n+1,0);
+    for (int u=0; u<n; ++u) offset[u+1]=offset[u]+(int)adjList[u].size();
+    vector<int> target(offset[n]);
+    vector<double> weight(offset[n]);
+    // rows sorted by (target, weight) give getEdgeWeight a binary search, with
+    // the cheapest of any parallel roads first
+    vector<pair<int,double>> row;
+    for (int u=0; u<n; ++u) {
+        row=adjList[u];
+        sort(row.begin(),row.end());
+        int pos=offset[u];
+        for (auto &p:row) {
+            target[pos]=p.first;
+            weight[pos]=p.second;
+            ++pos;
+        }
+    }
+    csrOffset.assign(move(offset));
+    csrTarget.assign(move(target));
+    csrWeight.assign(move(weight));
+    buildEdgeList();
+    chooseWeightMode();
+    calibrateGeoBound();
+    frozen=true;
+}
+void Graph::buildCoordinates() {
+    vector<double> c(2*(size_t)numVertices);
+    for (int i=0; i<numVertices; ++i) {
+        c[2*i]=attractions[i].latitude;
+        c[2*i+1]=attractions[i].longitude;
     }
-    aif.close();
-    ifstream rif(roadsFile);
-    if (!rif.is_open()) {
-        cerr<<"[graph] cannot open roads file: "<<roadsFile<<"\n";
-        buildDSU();
+    coords.assign(move(c));
+    geo.assign(coords.data(),numVertices);
+}
+void Graph::chooseWeightMode() {
+    static const int SCALES[]={1,10,100,1000};
+    weightScale=0;
+    maxIntWeight=0;
+    csrIntWeight.clear();
+    size_t m=csrWeight.size();
+    uniformWeightValue=m>0 && csrWeight[0]>0 ? csrWeight[0] : 0;
+    for (size_t e=1; e<m && uniformWeightValue>0; ++e)
+        if (csrWeight[e]!=uniformWeightValue) uniformWeightValue=0;
+    for (int scale:SCALES) {
+        vector<uint32_t> scaled(m);
+        bool ok=true;
+        uint32_t mx=0;
+        for (size_t e=0; e<m && ok; ++e) {
+            double x=csrWeight[e]*scale;
+            double r=nearbyint(x);
+            if (!(x>=0) || r>2147483647.0 || fabs(x-r)>1e-9*max(1.0,x)) ok=false;
+            else {
+                scaled[e]=(uint32_t)r;
+                mx=max(mx,scaled[e]);
+            }
+        }
+        if (!ok) continue;
+        weightScale=scale;
+        maxIntWeight=mx;
+        csrIntWeight.assign(move(scaled));
         return;
     }
-    if (!getline(rif,line)) { rif.close(); buildDSU(); return; } // header
-    while (getline(rif,line)) {
-        if (line.empty()) continue;
-        stringstream ss(line);
-        string fromN,toN,wS;
-        getline(ss,fromN,',');
-        getline(ss,toN,',');
-        getline(ss,wS,',');
-        int u=getIdByName(fromN);
-        int v=getIdByName(toN);
-        double w=1.0;
-        try { if (!wS.empty()) w=stod(wS); } catch(...) {}
-        if (u != -1 && v != -1) addEdge(u,v,w);
+}
+// The fastest road (meters per unit weight) caps how quickly any route can
+// close in on its goal: a route's cost is at least its great-circle length
+// times the cheapest weight per meter, and that length is at least the
+// great-circle distance between its ends. Roads of zero length say nothing
+// and are skipped.
+void Graph::calibrateGeoBound() {
+    geoCostPerMeter=0;
+    for (int u=0; u<numVertices; ++u)
+        if (csrOffset[u+1]>csrOffset[u] && !hasCoordinates(u)) return;
+    double best=numeric_limits<double>::infinity();
+    for (const Edge& e:edgeList) {
+        double len=greatCircleDistance(geo,e.u,e.v);
+        if (len>0) best=min(best,e.weight/len);
     }
-    rif.close();
-    buildDSU();
+    // shaved so rounding in the distance kernel cannot break consistency
+    if (best<numeric_limits<double>::infinity()) geoCostPerMeter=best*(1.0-1e-9);
 }
-vector<Edge> Graph::getAllEdges() const {
+void Graph::buildEdgeList() {
     vector<Edge> edges;
-    unordered_map<long long,bool> seen;
-    for (auto &kv:adjList) {
-        int u=kv.first;
-        for (auto &p:kv.second) {
-            int v=p.first;
-            double w=p.second;
-            int a=min(u,v),b=max(u,v);
-            long long key=((long long)a<<32) | (unsigned long long)b;
-            if (!seen[key]) {
-                Edge e; e.u=a; e.v=b; e.weight=w;
-                edges.push_back(e);
-                seen[key]=true;
-            }
-           }
-       }
-    return edges;
-}
\ No newline at end of file
+    edges.reserve(csrTarget.size()/2);
+    int n=(int)csrOffset.size()-1;
+    for (int u=0; u<n; ++u) {
+        int last=-1;
+        for (Neighbor nb:neighbors(u)) {
+            // rows are sorted by (target, weight): the first hit per target is the cheapest
+            if (nb.id<=u || nb.id==last) continue;
+            edges.push_back({u,nb.id,nb.weight});
+            last=nb.id;
+        }
+    }
+    stable_sort(edges.begin(),edges.end());
+    edgeList.assign(move(edges));
+}
+// Called before every modification. The weight modes and the geometric bound
+// describe the frozen roads, so they are dropped until the next freeze: searches
+// on an unfrozen graph then fall back to the heap and a zero heuristic instead
+// of reading scaled weights or positions the new nodes lack, or a bound that a
+// cheaper new road would break. A graph opened from a snapshot also has only
+// its CSR arrays, so its mutable adjacency lists are rebuilt here.
+void Graph::thaw() {
+    weightScale=0;
+    maxIntWeight=0;
+    uniformWeightValue=0;
+    csrIntWeight.clear();
+    geoCostPerMeter=0;
+    if ((int)adjList.size()==numVertices) return;
+    adjList.assign(numVertices,{});
+    for (int u=0; u<numVertices; ++u)
+        for (Neighbor nb:neighbors(u)) adjList[u].push_back({nb.id,nb.weight});
+}
+void Graph::clearAll() {
+    attractions.clear();
+    adjList.clear();
+    externalToDense.clear();
+    denseToExternal.clear();
+    nameToId.clear();
+    //above lines are required to CLEAR any
+    //old stored nodes/adj lists from prior,so cleared every single time(important)
+    numVertices=0;
+    component.clear();
+    csrOffset.clear();
+    csrTarget.clear();
+    csrWeight.clear();
+    edgeList.clear();
+    csrIntWeight.clear();
+    coords.clear();
+    geo=GeoPoints();
+    weightScale=0;
+    maxIntWeight=0;
+    uniformWeightValue=0;
+    geoCostPerMeter=0;
+    sourceStamps.clear();
+    dropDerivedIndexes();
+    frozen=false;
+}
+void Graph::dropDerivedIndexes() {
+    landmarkIndex.reset();
+    hierarchy.reset();
+    hubLabels.reset();
+    allPairsTable.reset();
+}
+void Graph::buildLandmarks(int k) {
+    if (!frozen) freeze();
+    landmarkIndex=LandmarkIndex::build(*this,k);
+}
+void Graph::buildContractionHierarchy(int threads) {
+    if (!frozen) freeze();
+    hierarchy=ContractionHierarchy::build(*this,threads);
+    hubLabels.reset(); // labels follow the hierarchy's order
+}
+void Graph::buildHubLabels() {
+    if (!hierarchy) buildContractionHierarchy();
+    auto t0=chrono::steady_clock::now();
+    auto labels=HubLabels::build(*hierarchy,weightScale);
+    double ms=chrono::duration<double,milli>(chrono::steady_clock::now()-t0).count();
+    cerr<<"[graph] hub labels: "<<labels->entryCount()<<" entries ("
+        <<(numVertices>0 ? (double)labels->entryCount()/numVertices : 0.0)<<" per node, "
+        <<labels->bytes()/1024<<" KiB) in "<<ms<<" ms"<<endl;
+    hubLabels=move(labels);
+}
+bool Graph::buildAllPairs(int threads) {
+    if (!frozen) freeze();
+    allPairsTable=AllPairsTable::build(*this,threads);
+    return allPairsTable!=nullptr;
+}
+// CSV loader expecting attractions.csv header: name,category,rating,duration,fee,popularity,latitude,longitude
+// and roads.csv header: from,to,time (names)
+ImportStats Graph::loadFromCSV(const string& attractionsFile,const string& roadsFile) {
+    clearAll();
+    // stamped first: an edit during the import makes the stamp stale, not the graph
+    vector<SnapshotSourceStamp> stamps;
+    for (const string* f:{&attractionsFile,&roadsFile}) {
+        SnapshotSourceStamp s={0,-1}; // kept for a missing file, which then never matches
+        stampSourceFile(*f,s);
+        stamps.push_back(s);
+    }
+    ImportStats stats=importGraphCSV(*this,attractionsFile,roadsFile);
+    sourceStamps=stamps;
+    cerr<<"[graph] imported "<<stats.attractionRows<<" attractions and "<<stats.roadRows<<" roads ("
+        <<(long long)stats.rowsPerSecond()<<" rows/s, "<<stats.threads<<" threads), "
+        <<stats.rejectedRows<<" rejected rows, "<<stats.malformedFields<<" malformed fields\n";
+    return stats;
+}
+shared_ptr<const GraphSnapshot> makeSnapshot(Graph&& g) {
+    if (!g.isFrozen() || !g.hasComponents()) g.buildDSU(); // buildDSU freezes first
+    return make_shared<const GraphSnapshot>(move(g));
+}
@@ -0,0 +1,327 @@
+#include "../include/graph.h"
+#include "../include/snapshot.h"
+#include "../include/mapped_file.h"
+#include "../include/landmarks.h"
+#include "../include/contraction_hierarchy.h"
+#include "../include/hub_labels.h"
+#include "../include/all_pairs.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#endif
+using namespace std;
+namespace {
+struct SectionBuffer {
+    uint32_t kind;
+    vector<char> bytes;
+};
+template <typename T>
+void appendRaw(vector<char>& out,const T* p,size_t n) {
+    const char* b=reinterpret_cast<const char*>(p);
+    out.insert(out.end(),b,b+n*sizeof(T));
+}
+SnapshotString poolString(string& pool,const string& s) {
+    SnapshotString r;
+    r.offset=(uint32_t)pool.size();
+    r.length=(uint32_t)s.size();
+    pool+=s;
+    return r;
+}
+const SnapshotSection* findSection(const SnapshotSection* dir,uint32_t count,uint32_t kind) {
+    for (uint32_t i=0; i<count; ++i) if (dir[i].kind==kind) return &dir[i];
+    return nullptr;
+}
+bool stringInPool(const SnapshotString& s,uint64_t poolSize) {
+    return (uint64_t)s.offset+s.length<=poolSize;
+}
+}
+bool stampSourceFile(const string& path,SnapshotSourceStamp& out) {
+#ifdef _WIN32
+    WIN32_FILE_ATTRIBUTE_DATA a;
+    if (!GetFileAttributesExA(path.c_str(),GetFileExInfoStandard,&a)) return false;
+    out.size=((uint64_t)a.nFileSizeHigh<<32)|a.nFileSizeLow;
+    uint64_t ticks=((uint64_t)a.ftLastWriteTime.dwHighDateTime<<32)|a.ftLastWriteTime.dwLowDateTime;
+    out.mtimeNs=(int64_t)(ticks-116444736000000000ULL)*100; // 100 ns ticks since 1601
+#else
+    struct stat st;
+    if (stat(path.c_str(),&st)!=0) return false;
+    out.size=(uint64_t)st.st_size;
+#ifdef __APPLE__
+    out.mtimeNs=(int64_t)st.st_mtimespec.tv_sec*1000000000+st.st_mtimespec.tv_nsec;
+#else
+    out.mtimeNs=(int64_t)st.st_mtim.tv_sec*1000000000+st.st_mtim.tv_nsec;
+#endif
+#endif
+    return true;
+}
+bool snapshotIsCurrent(const string& snapshotPath,const vector<string>& sources) {
+    ifstream in(snapshotPath,ios::binary);
+    SnapshotHeader h;
+    if (!in.read(reinterpret_cast<char*>(&h),sizeof(h))) return false;
+    if (memcmp(h.magic,SNAPSHOT_MAGIC,sizeof(h.magic))!=0) return false;
+    if (h.version!=SNAPSHOT_VERSION || h.byteOrder!=SNAPSHOT_BYTE_ORDER) return false;
+    if (h.sourceCount>SNAPSHOT_MAX_SOURCES || h.sourceCount!=sources.size()) return false;
+    for (size_t i=0; i<sources.size(); ++i) {
+        SnapshotSourceStamp now;
+        // a snapshot may be deployed without its sources
+        if (!stampSourceFile(sources[i],now)) continue;
+        if (now.size!=h.sources[i].size || now.mtimeNs!=h.sources[i].mtimeNs) return false;
+    }
+    return true;
+}
+bool Graph::saveSnapshot(const string& path) const {
+    if (!frozen) return false;
+    if (sourceStamps.size()>SNAPSHOT_MAX_SOURCES) {
+        // the header has room for this many; a snapshot missing some could never go stale
+        cerr<<"[graph] snapshot not saved: "<<sourceStamps.size()<<" source files, at most "<<SNAPSHOT_MAX_SOURCES<<endl;
+        return false;
+    }
+    int n=numVertices;
+    uint32_t edgeSlots=(uint32_t)csrTarget.size();
+    vector<SectionBuffer> sections;
+    sections.push_back({SECTION_CSR_OFFSETS,{}});
+    appendRaw(sections.back().bytes,csrOffset.data(),csrOffset.size());
+    sections.push_back({SECTION_CSR_TARGETS,{}});
+    appendRaw(sections.back().bytes,csrTarget.data(),csrTarget.size());
+    sections.push_back({SECTION_CSR_WEIGHTS,{}});
+    appendRaw(sections.back().bytes,csrWeight.data(),csrWeight.size());
+    vector<SnapshotAttraction> records(n);
+    string pool;
+    for (int i=0; i<n; ++i) {
+        const Attraction& a=attractions[i];
+        SnapshotAttraction& r=records[i];
+        r.externalId=denseToExternal[i];
+        r.popularity=a.popularity;
+        r.visitDuration=a.visitDuration;
+        r.rating=a.rating;
+        r.entryFee=a.entryFee;
+        r.name=poolString(pool,a.name);
+        r.category=poolString(pool,a.category);
+        r.description=poolString(pool,a.description);
+        r.openingHours=poolString(pool,a.openingHours);
+        string joined;
+        for (size_t t=0; t<a.tags.size(); ++t) {
+            if (t) joined+=SNAPSHOT_TAG_SEPARATOR;
+            joined+=a.tags[t];
+        }
+        r.tags=poolString(pool,joined);
+    }
+    sections.push_back({SECTION_COORDINATES,{}});
+    appendRaw(sections.back().bytes,coords.data(),coords.size());
+    sections.push_back({SECTION_ATTRACTIONS,{}});
+    appendRaw(sections.back().bytes,records.data(),records.size());
+    sections.push_back({SECTION_STRING_POOL,{}});
+    appendRaw(sections.back().bytes,pool.data(),pool.size());
+    sections.push_back({SECTION_EDGE_LIST,{}});
+    appendRaw(sections.back().bytes,edgeList.data(),edgeList.size());
+    if (landmarkIndex) {
+        sections.push_back({SECTION_LANDMARKS,{}});
+        landmarkIndex->serialize(sections.back().bytes);
+    }
+    if (hierarchy) {
+        sections.push_back({SECTION_CONTRACTION_HIERARCHY,{}});
+        hierarchy->serialize(sections.back().bytes);
+    }
+    if (hubLabels) {
+        sections.push_back({SECTION_HUB_LABELS,{}});
+        hubLabels->serialize(sections.back().bytes);
+    }
+    if (allPairsTable) {
+        sections.push_back({SECTION_ALL_PAIRS,{}});
+        allPairsTable->serialize(sections.back().bytes);
+    }
+    SnapshotWeightMode mode={weightScale,maxIntWeight,uniformWeightValue};
+    sections.push_back({SECTION_WEIGHT_MODE,{}});
+    appendRaw(sections.back().bytes,&mode,1);
+    appendRaw(sections.back().bytes,csrIntWeight.data(),csrIntWeight.size());
+    sections.push_back({SECTION_GEO_POINTS,{}});
+    for (const FrozenArray<double>* a:{&geo.lat,&geo.lon,&geo.cosLat,&geo.x,&geo.y,&geo.z})
+        appendRaw(sections.back().bytes,a->data(),a->size());
+    if (component.size()==(size_t)n) {
+        sections.push_back({SECTION_COMPONENTS,{}});
+        appendRaw(sections.back().bytes,component.data(),component.size());
+    }
+
+    SnapshotHeader h;
+    memcpy(h.magic,SNAPSHOT_MAGIC,sizeof(h.magic));
+    h.version=SNAPSHOT_VERSION;
+    h.byteOrder=SNAPSHOT_BYTE_ORDER;
+    h.nodeCount=(uint32_t)n;
+    h.edgeSlots=edgeSlots;
+    h.sectionCount=(uint32_t)sections.size();
+    memset(h.sources,0,sizeof(h.sources));
+    h.sourceCount=(uint32_t)sourceStamps.size();
+    for (uint32_t i=0; i<h.sourceCount; ++i) h.sources[i]=sourceStamps[i];
+    h.geoCostPerMeter=geoCostPerMeter;
+    vector<SnapshotSection> dir(sections.size());
+    uint64_t pos=sizeof(SnapshotHeader)+dir.size()*sizeof(SnapshotSection);
+    for (size_t i=0; i<sections.size(); ++i) {
+        pos=(pos+7)&~(uint64_t)7;
+        dir[i].kind=sections[i].kind;
+        dir[i].reserved=0;
+        dir[i].offset=pos;
+        dir[i].size=sections[i].bytes.size();
+        pos+=dir[i].size;
+    }
+    // write under a temporary name and rename, so concurrent readers never map a
+    // half-written file
+    string tmp=path+".tmp"+to_string(chrono::steady_clock::now().time_since_epoch().count());
+    {
+        ofstream out(tmp,ios::binary|ios::trunc);
+        if (!out.is_open()) return false;
+        out.write(reinterpret_cast<const char*>(&h),sizeof(h));
+        out.write(reinterpret_cast<const char*>(dir.data()),dir.size()*sizeof(SnapshotSection));
+        uint64_t written=sizeof(SnapshotHeader)+dir.size()*sizeof(SnapshotSection);
+        static const char zeros[8]={0};
+        for (size_t i=0; i<sections.size(); ++i) {
+            out.write(zeros,dir[i].offset-written);
+            out.write(sections[i].bytes.data(),sections[i].bytes.size());
+            written=dir[i].offset+dir[i].size;
+        }
+        if (!out) { out.close(); remove(tmp.c_str()); return false; }
+    }
+#ifdef _WIN32
+    remove(path.c_str());
+#endif
+    if (rename(tmp.c_str(),path.c_str())!=0) { remove(tmp.c_str()); return false; }
+    return true;
+}
+bool Graph::loadSnapshot(const string& path) {
+    auto file=make_shared<MappedFile>();
+    if (!file->open(path)) return false;
+    const char* base=file->data();
+    uint64_t len=file->size();
+    if (len<sizeof(SnapshotHeader)) return false;
+    SnapshotHeader h;
+    memcpy(&h,base,sizeof(h));
+    if (memcmp(h.magic,SNAPSHOT_MAGIC,sizeof(h.magic))!=0) return false;
+    if (h.version!=SNAPSHOT_VERSION || h.byteOrder!=SNAPSHOT_BYTE_ORDER) return false;
+    if (h.sourceCount>SNAPSHOT_MAX_SOURCES) return false;
+    if (sizeof(SnapshotHeader)+(uint64_t)h.sectionCount*sizeof(SnapshotSection)>len) return false;
+    const SnapshotSection* dir=reinterpret_cast<const SnapshotSection*>(base+sizeof(SnapshotHeader));
+    for (uint32_t i=0; i<h.sectionCount; ++i) {
+        if (dir[i].offset%8!=0 || dir[i].offset>len || dir[i].size>len-dir[i].offset) return false;
+    }
+    uint64_t n=h.nodeCount,m=h.edgeSlots;
+    const SnapshotSection* offS=findSection(dir,h.sectionCount,SECTION_CSR_OFFSETS);
+    const SnapshotSection* tgtS=findSection(dir,h.sectionCount,SECTION_CSR_TARGETS);
+    const SnapshotSection* wS=findSection(dir,h.sectionCount,SECTION_CSR_WEIGHTS);
+    const SnapshotSection* coordS=findSection(dir,h.sectionCount,SECTION_COORDINATES);
+    const SnapshotSection* attrS=findSection(dir,h.sectionCount,SECTION_ATTRACTIONS);
+    const SnapshotSection* poolS=findSection(dir,h.sectionCount,SECTION_STRING_POOL);
+    if (!offS || !tgtS || !wS || !coordS || !attrS || !poolS) return false;
+    if (offS->size!=(n+1)*sizeof(int32_t) || tgtS->size!=m*sizeof(int32_t) || wS->size!=m*sizeof(double)) return false;
+    if (coordS->size!=2*n*sizeof(double) || attrS->size!=n*sizeof(SnapshotAttraction)) return false;
+    const int* offsets=reinterpret_cast<const int*>(base+offS->offset);
+    const int* targets=reinterpret_cast<const int*>(base+tgtS->offset);
+    const double* weights=reinterpret_cast<const double*>(base+wS->offset);
+    const double* latLon=reinterpret_cast<const double*>(base+coordS->offset);
+    const SnapshotAttraction* records=reinterpret_cast<const SnapshotAttraction*>(base+attrS->offset);
+    const char* pool=base+poolS->offset;
+    // structural checks only: a damaged file must not send a search out of bounds
+    if (offsets[0]!=0 || (uint64_t)offsets[n]!=m) return false;
+    for (uint64_t i=0; i<n; ++i) if (offsets[i]>offsets[i+1]) return false;
+    for (uint64_t e=0; e<m; ++e) if (targets[e]<0 || (uint64_t)targets[e]>=n) return false;
+    for (uint64_t i=0; i<n; ++i) {
+        const SnapshotAttraction& r=records[i];
+        if (!stringInPool(r.name,poolS->size) || !stringInPool(r.category,poolS->size)) return false;
+        if (!stringInPool(r.description,poolS->size) || !stringInPool(r.openingHours,poolS->size)) return false;
+        if (!stringInPool(r.tags,poolS->size)) return false;
+    }
+    clearAll();
+    attractions.resize(n);
+    denseToExternal.resize(n);
+    nameToId.reserve(n);
+    for (uint64_t i=0; i<n; ++i) {
+        const SnapshotAttraction& r=records[i];
+        Attraction& a=attractions[i];
+        a.id=(int)i;
+        a.name.assign(pool+r.name.offset,r.name.length);
+        a.category.assign(pool+r.category.offset,r.category.length);
+        a.description.assign(pool+r.description.offset,r.description.length);
+        a.openingHours.assign(pool+r.openingHours.offset,r.openingHours.length);
+        const char* t=pool+r.tags.offset;
+        const char* tEnd=t+r.tags.length;
+        while (t<tEnd) {
+            const char* sep=static_cast<const char*>(memchr(t,SNAPSHOT_TAG_SEPARATOR,tEnd-t));
+            if (!sep) sep=tEnd;
+            a.tags.emplace_back(t,sep);
+            t=sep+1;
+        }
+        a.latitude=latLon[2*i];
+        a.longitude=latLon[2*i+1];
+        a.visitDuration=r.visitDuration;
+        a.rating=r.rating;
+        a.entryFee=r.entryFee;
+        a.popularity=r.popularity;
+        denseToExternal[i]=r.externalId;
+        externalToDense[r.externalId]=(int)i;
+        if (!a.name.empty()) nameToId.insert(a.name,(int)i);
+    }
+    numVertices=(int)n;
+    sourceStamps.assign(h.sources,h.sources+h.sourceCount);
+    csrOffset.attach(file,offsets,n+1);
+    csrTarget.attach(file,targets,m);
+    csrWeight.attach(file,weights,m);
+    coords.attach(file,latLon,2*n);
+    const SnapshotSection* geoS=findSection(dir,h.sectionCount,SECTION_GEO_POINTS);
+    if (geoS && geoS->size==6*n*sizeof(double)) geo.attach(file,reinterpret_cast<const double*>(base+geoS->offset),n);
+    else geo.assign(latLon,n);
+    const SnapshotSection* edgeS=findSection(dir,h.sectionCount,SECTION_EDGE_LIST);
+    bool edgesOk=edgeS && edgeS->size%sizeof(Edge)==0;
+    const Edge* edges=edgesOk ? reinterpret_cast<const Edge*>(base+edgeS->offset) : nullptr;
+    size_t edgeCount=edgesOk ? edgeS->size/sizeof(Edge) : 0;
+    for (size_t i=0; edgesOk && i<edgeCount; ++i)
+        if (edges[i].u<0 || edges[i].v<0 || (uint64_t)edges[i].u>=n || (uint64_t)edges[i].v>=n) edgesOk=false;
+    if (edgesOk) edgeList.attach(file,edges,edgeCount);
+    else buildEdgeList();
+    // weight mode as saved; files without it (or with a damaged one) re-derive it
+    const SnapshotSection* modeS=findSection(dir,h.sectionCount,SECTION_WEIGHT_MODE);
+    SnapshotWeightMode mode={0,0,0};
+    bool modeOk=modeS && modeS->size>=sizeof(mode);
+    if (modeOk) {
+        memcpy(&mode,base+modeS->offset,sizeof(mode));
+        uint64_t intBytes=mode.scale>0 ? m*sizeof(uint32_t) : 0;
+        modeOk=modeS->size==sizeof(mode)+intBytes && (mode.scale==0 || mode.scale==1 || mode.scale==10 ||
+            mode.scale==100 || mode.scale==1000) && mode.uniformWeight>=0;
+    }
+    const uint32_t* intWeights=modeOk ? reinterpret_cast<const uint32_t*>(base+modeS->offset+sizeof(mode)) : nullptr;
+    // a scaled weight above the maximum would break Dial's bucket invariant
+    for (uint64_t e=0; modeOk && mode.scale>0 && e<m; ++e) if (intWeights[e]>mode.maxIntWeight) modeOk=false;
+    if (modeOk) {
+        weightScale=mode.scale;
+        maxIntWeight=mode.maxIntWeight;
+        uniformWeightValue=mode.uniformWeight;
+        if (mode.scale>0) csrIntWeight.attach(file,intWeights,m);
+    } else chooseWeightMode();
+    // the bound as calibrated at freeze; one that is not a finite cost is recomputed
+    if (isfinite(h.geoCostPerMeter) && h.geoCostPerMeter>=0) geoCostPerMeter=h.geoCostPerMeter;
+    else calibrateGeoBound();
+    frozen=true;
+    const SnapshotSection* lmS=findSection(dir,h.sectionCount,SECTION_LANDMARKS);
+    if (lmS) landmarkIndex=LandmarkIndex::fromSnapshot(file,base+lmS->offset,lmS->size,(int)n);
+    const SnapshotSection* chS=findSection(dir,h.sectionCount,SECTION_CONTRACTION_HIERARCHY);
+    if (chS) hierarchy=ContractionHierarchy::fromSnapshot(file,base+chS->offset,chS->size,(int)n);
+    const SnapshotSection* hlS=findSection(dir,h.sectionCount,SECTION_HUB_LABELS);
+    if (hlS) hubLabels=HubLabels::fromSnapshot(file,base+hlS->offset,hlS->size,(int)n);
+    const SnapshotSection* apS=findSection(dir,h.sectionCount,SECTION_ALL_PAIRS);
+    if (apS) allPairsTable=AllPairsTable::fromSnapshot(file,base+apS->offset,apS->size,(int)n);
+    // component roots must point at roots inside the graph, else rebuild them
+    const SnapshotSection* compS=findSection(dir,h.sectionCount,SECTION_COMPONENTS);
+    const int* roots=compS && compS->size==n*sizeof(int32_t) ? reinterpret_cast<const int*>(base+compS->offset) : nullptr;
+    for (uint64_t i=0; roots && i<n; ++i)
+        if (roots[i]<0 || (uint64_t)roots[i]>=n || roots[roots[i]]!=roots[i]) roots=nullptr;
+    if (roots) component.attach(file,roots,n);
+    else buildDSU();
+    return true;
+}
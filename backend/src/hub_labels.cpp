@@ -0,0 +1,162 @@
+#include "../include/hub_labels.h"
+#include "../include/contraction_hierarchy.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+using namespace std;
+namespace {
+struct LabelEntry {
+    uint32_t hub;
+    double dist;
+};
+// Minimum d_a[i]+d_b[j] over equal hubs of two rank-sorted labels. Both indexes
+// advance without a data-dependent branch, so the loop compiles to compares and
+// conditional moves and does not stall on mispredictions. Sum is wide enough
+// to add two D values without overflow.
+template<class D,class Sum>
+Sum intersect(const uint32_t* ha,const D* da,size_t na,const uint32_t* hb,const D* db,size_t nb,Sum best) {
+    size_t i=0,j=0;
+    while (i<na && j<nb) {
+        uint32_t x=ha[i],y=hb[j];
+        Sum d=(Sum)da[i]+db[j];
+        best=(x==y && d<best) ? d : best;
+        i+=x<=y;
+        j+=y<=x;
+    }
+    return best;
+}
+}
+shared_ptr<HubLabels> HubLabels::build(const ContractionHierarchy& ch,int weightScale) {
+    auto hl=make_shared<HubLabels>();
+    int n=ch.size();
+    hl->nodeCount=n;
+    vector<int> byRank(n);
+    for (int v=0; v<n; ++v) byRank[ch.rankOf(v)]=v;
+    vector<vector<LabelEntry>> labels(n);
+    vector<uint32_t> hubs;
+    vector<double> dists;
+    // highest rank first: every upward neighbour's label is final before it is used
+    for (int r=n-1; r>=0; --r) {
+        int v=byRank[r];
+        vector<LabelEntry> cand{{(uint32_t)r,0.0}};
+        for (const CHArc* a=ch.upwardBegin(v); a!=ch.upwardEnd(v); ++a)
+            for (const LabelEntry& e:labels[a->target]) cand.push_back({e.hub,e.dist+a->weight});
+        sort(cand.begin(),cand.end(),[](const LabelEntry& a,const LabelEntry& b) {
+            return a.hub<b.hub || (a.hub==b.hub && a.dist<b.dist);
+        });
+        vector<LabelEntry>& label=labels[v];
+        for (const LabelEntry& e:cand)
+            if (label.empty() || label.back().hub!=e.hub) label.push_back(e);
+        // prune: an entry is kept only if no other common hub gives a shorter way
+        hubs.resize(label.size());
+        dists.resize(label.size());
+        for (size_t i=0; i<label.size(); ++i) { hubs[i]=label[i].hub; dists[i]=label[i].dist; }
+        size_t kept=0;
+        for (size_t i=0; i<label.size(); ++i) {
+            const vector<LabelEntry>& other=labels[byRank[label[i].hub]];
+            bool exact=true;
+            if (label[i].hub!=(uint32_t)r) {
+                double best=numeric_limits<double>::infinity();
+                size_t p=0;
+                for (const LabelEntry& e:other) {
+                    while (p<hubs.size() && hubs[p]<e.hub) ++p;
+                    if (p<hubs.size() && hubs[p]==e.hub) best=min(best,dists[p]+e.dist);
+                }
+                exact=!(best<label[i].dist);
+            }
+            if (exact) label[kept++]=label[i];
+        }
+        label.resize(kept);
+        label.shrink_to_fit();
+    }
+    vector<uint32_t> off(n+1,0);
+    for (int v=0; v<n; ++v) off[v+1]=off[v]+(uint32_t)labels[v].size();
+    hubs.assign(off[n],0);
+    dists.assign(off[n],0.0);
+    for (int v=0; v<n; ++v) {
+        for (size_t i=0; i<labels[v].size(); ++i) {
+            hubs[off[v]+i]=labels[v][i].hub;
+            dists[off[v]+i]=labels[v][i].dist;
+        }
+        vector<LabelEntry>().swap(labels[v]);
+    }
+    hl->offset.assign(move(off));
+    hl->hub.assign(move(hubs));
+    // integer graphs: every label distance is a sum of scaled weights, so it
+    // rounds back exactly unless it outgrows uint32
+    vector<uint32_t> scaled(weightScale>0 ? dists.size() : 0);
+    bool ok=weightScale>0;
+    for (size_t e=0; e<scaled.size() && ok; ++e) {
+        double x=dists[e]*weightScale;
+        double r=nearbyint(x);
+        if (!(x>=0) || r>4294967295.0 || fabs(x-r)>1e-9*max(1.0,x)) ok=false;
+        else scaled[e]=(uint32_t)r;
+    }
+    if (ok) {
+        hl->distScale=weightScale;
+        hl->scaledDist.assign(move(scaled));
+    } else hl->dist.assign(move(dists));
+    return hl;
+}
+double HubLabels::distance(int u,int v) const {
+    if (u<0 || v<0 || u>=nodeCount || v>=nodeCount) return numeric_limits<double>::infinity();
+    if (u==v) return 0.0;
+    uint32_t bu=offset[u],bv=offset[v],nu=offset[u+1]-bu,nv=offset[v+1]-bv;
+    if (distScale==0)
+        return intersect(hub.data()+bu,dist.data()+bu,nu,hub.data()+bv,dist.data()+bv,nv,numeric_limits<double>::infinity());
+    uint64_t best=intersect(hub.data()+bu,scaledDist.data()+bu,nu,hub.data()+bv,scaledDist.data()+bv,nv,numeric_limits<uint64_t>::max());
+    return best==numeric_limits<uint64_t>::max() ? numeric_limits<double>::infinity() : (double)best/distScale;
+}
+vector<vector<double>> HubLabels::distanceMatrix(const vector<int>& sources,const vector<int>& targets) const {
+    vector<vector<double>> table(sources.size(),vector<double>(targets.size()));
+    for (size_t i=0; i<sources.size(); ++i)
+        for (size_t j=0; j<targets.size(); ++j) table[i][j]=distance(sources[i],targets[j]);
+    return table;
+}
+// Section layout: uint32 nodeCount, uint32 entryCount, uint32 scale,
+// uint32 offset[nodeCount+1], uint32 hub[entryCount], padding to 8 bytes, then
+// double dist[entryCount] if scale is 0, else uint32 dist[entryCount] (scaled).
+static size_t labelDistOffset(uint32_t n,uint32_t m) {
+    return ((3+(size_t)n+1+m)*sizeof(uint32_t)+7)&~(size_t)7;
+}
+void HubLabels::serialize(vector<char>& out) const {
+    uint32_t n=(uint32_t)nodeCount,m=(uint32_t)hub.size(),scale=(uint32_t)distScale;
+    size_t off=labelDistOffset(n,m),width=scale ? sizeof(uint32_t) : sizeof(double);
+    out.assign(off+(size_t)m*width,0);
+    memcpy(out.data(),&n,sizeof(n));
+    memcpy(out.data()+4,&m,sizeof(m));
+    memcpy(out.data()+8,&scale,sizeof(scale));
+    if (!offset.empty()) memcpy(out.data()+12,offset.data(),offset.size()*sizeof(uint32_t));
+    if (m) {
+        memcpy(out.data()+12+4*((size_t)n+1),hub.data(),(size_t)m*sizeof(uint32_t));
+        memcpy(out.data()+off,scale ? (const void*)scaledDist.data() : (const void*)dist.data(),(size_t)m*width);
+    }
+}
+shared_ptr<HubLabels> HubLabels::fromSnapshot(shared_ptr<const MappedFile> file,const char* data,size_t size,int nodeCount) {
+    if (size<12) return nullptr;
+    uint32_t n,m,scale;
+    memcpy(&n,data,sizeof(n));
+    memcpy(&m,data+4,sizeof(m));
+    memcpy(&scale,data+8,sizeof(scale));
+    if ((int)n!=nodeCount || n==0 || scale>1000) return nullptr;
+    size_t off=labelDistOffset(n,m);
+    if (size!=off+(size_t)m*(scale ? sizeof(uint32_t) : sizeof(double))) return nullptr;
+    const uint32_t* offsets=reinterpret_cast<const uint32_t*>(data+12);
+    const uint32_t* hubs=offsets+n+1;
+    const double* dists=reinterpret_cast<const double*>(data+off);
+    if (offsets[0]!=0 || offsets[n]!=m) return nullptr;
+    for (uint32_t i=0; i<n; ++i) if (offsets[i]>offsets[i+1]) return nullptr;
+    // hubs must be ascending within a label for the merge to be correct
+    for (uint32_t v=0; v<n; ++v)
+        for (uint32_t e=offsets[v]; e<offsets[v+1]; ++e)
+            if (hubs[e]>=n || (e>offsets[v] && hubs[e]<=hubs[e-1]) || (!scale && !(dists[e]>=0))) return nullptr;
+    auto hl=make_shared<HubLabels>();
+    hl->nodeCount=(int)n;
+    hl->distScale=(int)scale;
+    hl->offset.attach(file,offsets,n+1);
+    hl->hub.attach(file,hubs,m);
+    if (scale) hl->scaledDist.attach(move(file),reinterpret_cast<const uint32_t*>(data+off),m);
+    else hl->dist.attach(move(file),dists,m);
+    return hl;
+}
@@ -6,11 +6,14 @@ using namespace std;
 vector<Edge> kruskalMST(vector<Edge>& edges,int n) {
     sort(edges.begin(),edges.end(),[](const Edge& a,const Edge& b)
     { return a.weight<b.weight; });
+    return kruskalMSTSorted(edges.data(),edges.size(),n);
+}
+vector<Edge> kruskalMSTSorted(const Edge* edges,size_t count,int n) {
     DSU dsu(n);
     vector<Edge> mst;
     // Build the MST by picking the smallest edges that don't form a cycle
     //(unite,union find for efficient(stop cycles))
-    for (size_t i=0; i<edges.size(); ++i) {
+    for (size_t i=0; i<count; ++i) {
         if (edges[i].u<0 || edges[i].v<0) continue;
         if (edges[i].u>=n || edges[i].v>=n) continue;
         if (dsu.unite(edges[i].u,edges[i].v)) {
@@ -0,0 +1,116 @@
+#include "../include/landmarks.h"
+#include "../include/algorithms.h"
+#include "../include/graph.h"
+#include "../include/potential_search.h"
+#include "../include/search_workspace.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+using namespace std;
+shared_ptr<LandmarkIndex> LandmarkIndex::build(const Graph& g,int k) {
+    const double INF=numeric_limits<double>::infinity();
+    auto lm=make_shared<LandmarkIndex>();
+    int n=g.maxNodeId()+1;
+    lm->nodeCount=max(n,0);
+    if (n<=0 || k<=0) return lm;
+    k=min(k,n);
+    vector<double> dists((size_t)n*k,INF);
+    vector<double> nearest(n,INF); // distance to the closest chosen landmark
+    SearchWorkspace ws;
+    // start from the node farthest from node 0, a cheap stand-in for a periphery node
+    dijkstraSearch(g,0,ws);
+    int next=0;
+    for (int v=0; v<n; ++v)
+        if (ws.distance(v)<INF && ws.distance(v)>ws.distance(next)) next=v;
+    for (int i=0; i<k; ++i) {
+        lm->landmarkIds.push_back(next);
+        dijkstraSearch(g,next,ws);
+        for (int v=0; v<n; ++v) {
+            double d=ws.distance(v);
+            dists[(size_t)v*k+i]=d;
+            if (d<nearest[v]) nearest[v]=d;
+        }
+        next=-1;
+        for (int v=0; v<n; ++v) {
+            if (nearest[v]==0) continue; // already a landmark (or at distance 0 from one)
+            if (next==-1 || nearest[v]>nearest[next]) next=v;
+        }
+        if (next==-1) break;
+    }
+    int chosen=(int)lm->landmarkIds.size();
+    if (chosen<k) {
+        // fewer distinct landmarks than asked for: compact the table
+        vector<double> packed((size_t)n*chosen);
+        for (int v=0; v<n; ++v)
+            for (int i=0; i<chosen; ++i) packed[(size_t)v*chosen+i]=dists[(size_t)v*k+i];
+        dists.swap(packed);
+    }
+    lm->table.assign(move(dists));
+    return lm;
+}
+double LandmarkIndex::lowerBound(int u,int v) const {
+    int k=count();
+    if (k==0 || u<0 || v<0 || u>=nodeCount || v>=nodeCount) return 0.0;
+    const double* du=table.data()+(size_t)u*k;
+    const double* dv=table.data()+(size_t)v*k;
+    double best=0.0;
+    for (int i=0; i<k; ++i) {
+        bool fu=isfinite(du[i]),fv=isfinite(dv[i]);
+        if (fu!=fv) return numeric_limits<double>::infinity(); // different components
+        if (!fu) continue;
+        double b=fabs(du[i]-dv[i]);
+        if (b>best) best=b;
+    }
+    return best;
+}
+// Section layout: uint32 k, uint32 nodeCount, int32 landmarks[k], padding to 8
+// bytes, double table[nodeCount*k].
+static size_t landmarkTableOffset(uint32_t k) {
+    return ((2+(size_t)k)*sizeof(uint32_t)+7)&~(size_t)7;
+}
+void LandmarkIndex::serialize(vector<char>& out) const {
+    uint32_t k=(uint32_t)count(),n=(uint32_t)nodeCount;
+    size_t off=landmarkTableOffset(k);
+    out.assign(off+table.size()*sizeof(double),0);
+    memcpy(out.data(),&k,sizeof(k));
+    memcpy(out.data()+4,&n,sizeof(n));
+    for (uint32_t i=0; i<k; ++i) {
+        int32_t id=landmarkIds[i];
+        memcpy(out.data()+8+4*i,&id,sizeof(id));
+    }
+    if (!table.empty()) memcpy(out.data()+off,table.data(),table.size()*sizeof(double));
+}
+shared_ptr<LandmarkIndex> LandmarkIndex::fromSnapshot(shared_ptr<const MappedFile> file,const char* data,size_t size,int nodeCount) {
+    if (size<8) return nullptr;
+    uint32_t k,n;
+    memcpy(&k,data,sizeof(k));
+    memcpy(&n,data+4,sizeof(n));
+    if ((int)n!=nodeCount || k>n) return nullptr;
+    size_t off=landmarkTableOffset(k);
+    if (size!=off+(size_t)n*k*sizeof(double)) return nullptr;
+    auto lm=make_shared<LandmarkIndex>();
+    lm->nodeCount=(int)n;
+    for (uint32_t i=0; i<k; ++i) {
+        int32_t id;
+        memcpy(&id,data+8+4*i,sizeof(id));
+        if (id<0 || (uint32_t)id>=n) return nullptr;
+        lm->landmarkIds.push_back(id);
+    }
+    const double* dists=reinterpret_cast<const double*>(data+off);
+    for (size_t i=0; i<(size_t)n*k; ++i)
+        if (!(dists[i]>=0)) return nullptr; // negative or NaN: damaged section
+    lm->table.attach(move(file),dists,(size_t)n*k);
+    return lm;
+}
+pair<double,vector<int>> altPath(const Graph& g,const LandmarkIndex& lm,int source,int target,SearchWorkspace& ws) {
+    double d=aStarSearch(g,source,target,ws,[&](int v) { return lm.lowerBound(v,target); });
+    if (d==numeric_limits<double>::infinity()) return {d,{}};
+    return {d,ws.pathTo(source,target)};
+}
+pair<double,vector<int>> altBidirectionalPath(const Graph& g,const LandmarkIndex& lm,int source,int target,
+    SearchWorkspace& fwd,SearchWorkspace& bwd) {
+    return bidirectionalAStarSearch(g,source,target,fwd,bwd,
+        [&](int v) { return lm.lowerBound(v,target); },
+        [&](int v) { return lm.lowerBound(source,v); });
+}
@@ -0,0 +1,60 @@
+#include "../include/mapped_file.h"
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+using namespace std;
+#ifdef _WIN32
+MappedFile::MappedFile():base(nullptr),length(0),fileHandle(nullptr),mapHandle(nullptr) {}
+#else
+MappedFile::MappedFile():base(nullptr),length(0),fd(-1) {}
+#endif
+MappedFile::~MappedFile() { close(); }
+bool MappedFile::open(const string& path) {
+    close();
+#ifdef _WIN32
+    HANDLE f=CreateFileA(path.c_str(),GENERIC_READ,FILE_SHARE_READ,nullptr,OPEN_EXISTING,FILE_ATTRIBUTE_NORMAL,nullptr);
+    if (f==INVALID_HANDLE_VALUE) return false;
+    LARGE_INTEGER sz;
+    if (!GetFileSizeEx(f,&sz) || sz.QuadPart==0) { CloseHandle(f); return false; }
+    HANDLE m=CreateFileMappingA(f,nullptr,PAGE_READONLY,0,0,nullptr);
+    if (!m) { CloseHandle(f); return false; }
+    void* p=MapViewOfFile(m,FILE_MAP_READ,0,0,0);
+    if (!p) { CloseHandle(m); CloseHandle(f); return false; }
+    fileHandle=f;
+    mapHandle=m;
+    base=static_cast<const char*>(p);
+    length=(size_t)sz.QuadPart;
+#else
+    int h=::open(path.c_str(),O_RDONLY);
+    if (h<0) return false;
+    struct stat st;
+    if (fstat(h,&st)!=0 || st.st_size==0) { ::close(h); return false; }
+    void* p=mmap(nullptr,(size_t)st.st_size,PROT_READ,MAP_PRIVATE,h,0);
+    if (p==MAP_FAILED) { ::close(h); return false; }
+    fd=h;
+    base=static_cast<const char*>(p);
+    length=(size_t)st.st_size;
+#endif
+    return true;
+}
+void MappedFile::close() {
+    if (!base) return;
+#ifdef _WIN32
+    UnmapViewOfFile(base);
+    CloseHandle((HANDLE)mapHandle);
+    CloseHandle((HANDLE)fileHandle);
+    fileHandle=nullptr;
+    mapHandle=nullptr;
+#else
+    munmap(const_cast<char*>(base),length);
+    ::close(fd);
+    fd=-1;
+#endif
+    base=nullptr;
+    length=0;
+}
@@ -0,0 +1,78 @@
+#include "../include/name_index.h"
+using namespace std;
+uint32_t NameIndex::hashName(string_view name) {
+    // 64-bit FNV-1a folded to 32 bits
+    uint64_t h=1469598103934665603ULL;
+    for (unsigned char c:name) {
+        h^=c;
+        h*=1099511628211ULL;
+    }
+    return (uint32_t)(h^(h>>32));
+}
+void NameIndex::clear() {
+    slots.clear();
+    pool.clear();
+    count=0;
+    used=0;
+}
+void NameIndex::reserve(size_t names) {
+    size_t cap=16;
+    while (cap<names*2) cap<<=1;
+    if (cap>slots.size()) rehash(cap);
+}
+void NameIndex::rehash(size_t capacity) {
+    vector<Slot> old;
+    old.swap(slots);
+    slots.assign(capacity,Slot{0,EMPTY,0,0});
+    used=count;
+    size_t mask=capacity-1;
+    for (const Slot& s:old) {
+        if (s.id<0) continue;
+        size_t i=s.hash&mask;
+        while (slots[i].id!=EMPTY) i=(i+1)&mask;
+        slots[i]=s;
+    }
+}
+void NameIndex::insert(string_view name,int id) {
+    if (slots.empty()) rehash(16);
+    else if ((size_t)(used+1)*2>slots.size())
+        rehash((size_t)count*4>=slots.size() ? slots.size()*2 : slots.size()); // same size just drops tombstones
+    uint32_t h=hashName(name);
+    size_t mask=slots.size()-1;
+    size_t i=h&mask;
+    size_t firstFree=slots.size();
+    while (slots[i].id!=EMPTY) {
+        if (matches(slots[i],h,name)) { slots[i].id=id; return; }
+        if (slots[i].id==TOMBSTONE && firstFree==slots.size()) firstFree=i;
+        i=(i+1)&mask;
+    }
+    if (firstFree==slots.size()) { firstFree=i; ++used; }
+    Slot& s=slots[firstFree];
+    s.hash=h;
+    s.id=id;
+    s.offset=(uint32_t)pool.size();
+    s.length=(uint32_t)name.size();
+    pool.append(name.data(),name.size());
+    ++count;
+}
+void NameIndex::erase(string_view name) {
+    if (slots.empty()) return;
+    uint32_t h=hashName(name);
+    size_t mask=slots.size()-1;
+    for (size_t i=h&mask; slots[i].id!=EMPTY; i=(i+1)&mask) {
+        if (matches(slots[i],h,name)) {
+            slots[i].id=TOMBSTONE;
+            --count;
+            return;
+        }
+    }
+}
+int NameIndex::find(string_view name) const {
+    if (slots.empty()) return -1;
+    uint32_t h=hashName(name);
+    size_t mask=slots.size()-1;
+    for (size_t i=h&mask; slots[i].id!=EMPTY; i=(i+1)&mask) {
+        if (matches(slots[i],h,name)) return slots[i].id;
+    }
+    return -1;
+}
@@ -1,5 +1,6 @@
 #include "../include/route_optimizer.h"
 #include "../include/algorithms.h"
+#include "../include/search_workspace.h"
 #include <algorithm>
 #include <unordered_set>
 #include <limits>
@@ -8,8 +9,6 @@ using namespace std;
 // function that is defined in another file or another scope.
 extern vector<Edge> kruskalMST(vector<Edge>& edges, int n);
 extern vector<int> mstToTour(const vector<Edge>& mst, int n, int start);
-extern vector<int> aStarPath(const Graph& g, int start, int goal);
-extern pair<vector<double>, vector<int>> dijkstraWithPath(const Graph& g, int start);
 // Helper: append a reconstructed segment to fullPath
 static void appendSegment(vector<int>& fullPath, const vector<int>& segment) {
     if (segment.empty()) return;
@@ -20,24 +19,63 @@ static void appendSegment(vector<int>& fullPath, const vector<int>& segment) {
         fullPath.insert(fullPath.end(), segment.begin(), segment.end());
     }
 }
+// One leg by search: exact bidirectional A*, or weighted A* when
+// options.epsilon>0. Empty if unreachable.
+vector<int> RouteOptimizer::searchLeg(int from, int to, RouteResult& res) const {
+    const Graph& graph = *snapshot;
+    if (options.epsilon > 0) {
+        vector<int> path = aStarPath(graph, from, to, options.epsilon);
+        res.settledNodes += threadWorkspace().settled();
+        return path;
+    }
+    vector<int> path = bidirectionalAStarPath(graph, from, to);
+    res.settledNodes += threadWorkspace().settled() + threadReverseWorkspace().settled();
+    return path;
+}
+// One leg: looked up in the all-pairs table or hierarchy when the graph has one
+// and the leg must be exact, else searched. Returns (cost, path); infinite cost
+// and an empty path if unreachable.
+pair<double, vector<int>> RouteOptimizer::routeLeg(int from, int to, RouteResult& res) const {
+    const Graph& graph = *snapshot;
+    if (options.epsilon <= 0 && graph.allPairs()) return shortestPath(graph, from, to);
+    if (options.epsilon <= 0 && graph.contractionHierarchy()) {
+        auto leg = shortestPath(graph, from, to);
+        res.settledNodes += threadWorkspace().settled() + threadReverseWorkspace().settled();
+        return leg;
+    }
+    vector<int> path = searchLeg(from, to, res);
+    if (path.empty()) return {numeric_limits<double>::infinity(), {}};
+    double cost = graph.pathCost(path);
+    return {cost, move(path)};
+}
+// What answers the legs, as routeLeg (indexed) or searchLeg would choose it.
+const char* RouteOptimizer::legSearchName(bool indexed) const {
+    if (options.epsilon > 0) return "weighted A*";
+    if (indexed && snapshot->allPairs()) return "all-pairs table";
+    if (indexed && snapshot->contractionHierarchy()) return "contraction hierarchy";
+    return "bidirectional A*";
+}
 // FULL GRAPH TRAVERSAL (MST + DFS + A*)
 RouteResult RouteOptimizer::computeFullGraphRoute() {
     RouteResult res;
     res.algorithm = "Kruskal + DFS + A*";
+    if (!snapshot) return res;
+    if (options.epsilon > 0) res.suboptimalityBound = 1.0 + options.epsilon;
+    res.legSearch = legSearchName(false);
+    const Graph& graph = *snapshot;
     vector<int> nodes = graph.getAllAttractionIds();
     if (nodes.empty()) return res;
-    DSU* dsu = graph.getDSU();
-    if (!dsu) return res;
-    int root = dsu->find(nodes[0]);
+    if (!graph.hasComponents()) return res;
+    int root = graph.getComponent(nodes[0]);
     for (int id : nodes) {
-        if (dsu->find(id) != root) {
+        if (graph.getComponent(id) != root) {
             res.algorithm += " (Graph Not Connected)";
             return res;
         }
     }
-    vector<Edge> edges = graph.getAllEdges();
+    const auto& edges = graph.getAllEdges(); // canonical, already sorted by weight
     int maxId = graph.maxNodeId();
-    vector<Edge> mst = kruskalMST(edges, maxId + 1);
+    vector<Edge> mst = kruskalMSTSorted(edges.data(), edges.size(), maxId + 1);
     int startNode = *min_element(nodes.begin(), nodes.end());
     vector<int> traversal = mstToTour(mst, maxId + 1, startNode);
     vector<int> finalOrder;
@@ -53,22 +91,15 @@ RouteResult RouteOptimizer::computeFullGraphRoute() {
     for (size_t i = 0; i + 1 < finalOrder.size(); ++i) {
         int u = finalOrder[i];
         int v = finalOrder[i + 1];
-        vector<int> path = aStarPath(graph, u, v);
+        vector<int> path = searchLeg(u, v, res);
         if (path.empty()) {
-            // fallback Dijkstra
-            auto dres = dijkstraWithPath(graph, u);
-            if (dres.first[v] == numeric_limits<double>::infinity()) {
-                res.algorithm += " (Unreachable Segment)";
-                continue;
-            }
-            path = reconstructPath(dres.second, u, v);
+            // A* finds a path whenever one exists (zero heuristic without coordinates)
+            res.algorithm += " (Unreachable Segment)";
+            continue;
         }
         appendSegment(res.fullPath, path);
         // accumulate time
-        for (size_t k = 0; k + 1 < path.size(); ++k) {
-            auto dres2 = dijkstraWithPath(graph, path[k]);
-            total += dres2.first[path[k + 1]];
-        }
+        total += graph.pathCost(path);
     }
     res.totalTime = total;
     return res;
@@ -76,7 +107,8 @@ RouteResult RouteOptimizer::computeFullGraphRoute() {
 // FIXED ORDER (Dijkstra) + FLEXIBLE ORDER (TSP)
 RouteResult RouteOptimizer::computeOptimalRoute(const vector<int>& locs, bool flexible) {
     RouteResult rr;
-    if (locs.empty()) return rr;
+    if (locs.empty() || !snapshot) return rr;
+    const Graph& graph = *snapshot;
     if (locs.size() == 1) {
         rr.attractionIds = locs;
         rr.fullPath = locs;
@@ -84,6 +116,8 @@ RouteResult RouteOptimizer::computeOptimalRoute(const vector<int>& locs, bool fl
         rr.algorithm = "Single";
         return rr;
     }
+    if (options.epsilon > 0) rr.suboptimalityBound = 1.0 + options.epsilon;
+    rr.legSearch = legSearchName(true);
     // FIXED ORDER
     if (!flexible) {
         rr.algorithm = "Fixed Order";
@@ -92,14 +126,13 @@ RouteResult RouteOptimizer::computeOptimalRoute(const vector<int>& locs, bool fl
         for (size_t i = 0; i + 1 < locs.size(); ++i) {
             int u = locs[i];
             int v = locs[i + 1];
-            auto dres = dijkstraWithPath(graph, u);
-            if (dres.first[v] == numeric_limits<double>::infinity()) {
+            auto leg = routeLeg(u, v, rr);
+            if (leg.first == numeric_limits<double>::infinity()) {
                 total += 1e9;
                 continue;
             }
-            vector<int> segment = reconstructPath(dres.second, u, v);
-            appendSegment(rr.fullPath, segment);
-            total += dres.first[v];
+            appendSegment(rr.fullPath, leg.second);
+            total += leg.first;
         }
 
         rr.totalTime = total;
@@ -111,13 +144,15 @@ RouteResult RouteOptimizer::computeOptimalRoute(const vector<int>& locs, bool fl
     rr.totalTime = tspRes.first;
     for (int idx : tspRes.second)
         rr.attractionIds.push_back(locs[idx]);
-    // Build full expanded path
+    // Build full expanded path; approximate legs are costed as walked
+    double walked = 0;
     for (size_t i = 0; i + 1 < rr.attractionIds.size(); ++i) {
         int u = rr.attractionIds[i];
         int v = rr.attractionIds[i + 1];
-        auto dres = dijkstraWithPath(graph, u);
-        vector<int> segment = reconstructPath(dres.second, u, v);
-        appendSegment(rr.fullPath, segment);
+        auto leg = routeLeg(u, v, rr);
+        appendSegment(rr.fullPath, leg.second);
+        walked += leg.first;
     }
+    if (options.epsilon > 0) rr.totalTime = walked;
     return rr;
 }
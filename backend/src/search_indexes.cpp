@@ -0,0 +1,44 @@
+#include "../include/search_indexes.h"
+#include "../include/graph.h"
+#include "../include/all_pairs.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+using namespace std;
+namespace {
+bool envFlag(const char* name) {
+    const char* v=getenv(name);
+    return v && (strcmp(v,"1")==0 || strcmp(v,"true")==0 || strcmp(v,"on")==0);
+}
+struct IndexSet {
+    bool landmarks, allPairs, hierarchy, hubLabels;
+};
+// what buildSearchIndexes produces for g under options
+IndexSet plannedIndexes(const Graph& g,const SearchIndexOptions& options) {
+    IndexSet s;
+    bool any=g.size()>0;
+    s.landmarks=any;
+    s.allPairs=any && options.allPairs && g.size()<=APSP_MAX_NODES;
+    s.hierarchy=any && !s.allPairs;
+    s.hubLabels=s.hierarchy && options.hubLabels;
+    return s;
+}
+}
+SearchIndexOptions SearchIndexOptions::fromEnvironment() {
+    SearchIndexOptions o;
+    o.allPairs=envFlag("NAVRA_ALL_PAIRS");
+    o.hubLabels=envFlag("NAVRA_HUB_LABELS");
+    return o;
+}
+void buildSearchIndexes(Graph& g,const SearchIndexOptions& options) {
+    IndexSet s=plannedIndexes(g,options);
+    if (s.landmarks) g.buildLandmarks(min(8,g.size()));
+    if (s.allPairs) g.buildAllPairs();
+    if (s.hierarchy) g.buildContractionHierarchy();
+    if (s.hubLabels) g.buildHubLabels();
+}
+bool hasSearchIndexes(const Graph& g,const SearchIndexOptions& options) {
+    IndexSet s=plannedIndexes(g,options);
+    return s.landmarks==(g.landmarks()!=nullptr) && s.allPairs==(g.allPairs()!=nullptr) &&
+        s.hierarchy==(g.contractionHierarchy()!=nullptr) && s.hubLabels==(g.hubLabelIndex()!=nullptr);
+}
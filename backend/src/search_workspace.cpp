@@ -0,0 +1,42 @@
+#include "../include/search_workspace.h"
+#include <algorithm>
+using namespace std;
+void SearchWorkspace::reset(int n) {
+    if ((int)dist.size()<n) {
+        dist.resize(n);
+        parent.resize(n);
+        stamp.resize(n,0);
+        markStamp.resize(n,0);
+        potentialValue.resize(n);
+        potentialStamp.resize(n,0);
+    }
+    settledCount=0;
+    heap.resize(n);
+    heap.clear();
+    if (++generation==0) {
+        // counter wrapped: old stamps could alias the new generation
+        fill(stamp.begin(),stamp.end(),0);
+        fill(markStamp.begin(),markStamp.end(),0);
+        fill(potentialStamp.begin(),potentialStamp.end(),0);
+        generation=1;
+    }
+}
+vector<int> SearchWorkspace::pathTo(int start,int end) const {
+    vector<int> path;
+    if (end<0 || end>=(int)dist.size() || !reached(end)) return path;
+    for (int cur=end; cur!=-1; cur=parentOf(cur)) {
+        path.push_back(cur);
+        if (cur==start) break;
+    }
+    reverse(path.begin(),path.end());
+    if (!path.empty() && path.front()==start) return path;
+    return vector<int>();
+}
+SearchWorkspace& threadWorkspace() {
+    thread_local SearchWorkspace ws;
+    return ws;
+}
+SearchWorkspace& threadReverseWorkspace() {
+    thread_local SearchWorkspace ws;
+    return ws;
+}
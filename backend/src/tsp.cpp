@@ -8,23 +8,15 @@ using namespace std;
 const double INF=numeric_limits<double>::infinity();
 static vector<vector<double>> generateDistanceMatrix(const Graph& g,const vector<int>& locs) {
     int n =(int)locs.size();
-    vector<vector<double>> dist(n,vector<double>(n,INF));
-    for (int i=0; i<n; ++i) {
-        auto d=dijkstra(g,locs[i]);
-        for (int j=0; j<n; ++j) {
-            if (j<(int)d.size()) dist[i][j]=d[locs[j]];
-        }
-        dist[i][i]=0;
-    }
+    vector<vector<double>> dist=distanceMatrix(g,locs,locs);
+    for (int i=0; i<n; ++i) dist[i][i]=0;
     return dist;
 }
 pair<double,vector<int>> computeOrderedRoute(const Graph& g,const vector<int>& order) {
     double total=0;
     vector<int> r=order;
     for (size_t i=0; i+1<order.size(); ++i) {
-        auto dres=dijkstraWithPath(g,order[i]);
-        double seg=INF;
-        if (order[i+1]>=0 && order[i+1]<(int)dres.first.size()) seg=dres.first[order[i+1]];
+        double seg=shortestPath(g,order[i],order[i+1]).first;
         if (seg==INF) total+=1e9;
         else total+=seg;
     }
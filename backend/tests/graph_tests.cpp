@@ -0,0 +1,758 @@
+// Regression tests for the graph core. Built and run by `make test`; exits
+// non-zero if any check fails.
+#include <cstdio>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <queue>
+#include <random>
+#include <string>
+#include <vector>
+#include "../include/graph.h"
+#include "../include/snapshot.h"
+#include "../include/algorithms.h"
+#include "../include/search_indexes.h"
+#include "../include/all_pairs.h"
+#include "../include/bit_bfs.h"
+#include "../include/csv_import.h"
+#include "../include/name_index.h"
+#include "../include/route_optimizer.h"
+#include "../include/geo.h"
+#include "../include/hub_labels.h"
+#include "../include/landmarks.h"
+#include "../include/search_workspace.h"
+using namespace std;
+namespace {
+int failures=0;
+#define CHECK(cond) do { if (!(cond)) { ++failures; printf("%s:%d: CHECK failed: %s\n",__FILE__,__LINE__,#cond); } } while (0)
+const char* SNAPSHOT_PATH="graph_tests.snapshot";
+const char* ATTRACTIONS_PATH="graph_tests_attractions.csv";
+const char* ROADS_PATH="graph_tests_roads.csv";
+void writeFile(const char* path,const string& text,bool append=false) {
+    ofstream out(path,append ? ios::app : ios::trunc);
+    out<<text;
+}
+// Rewrites the header of the snapshot at SNAPSHOT_PATH in place.
+template <typename Edit>
+void editSnapshotHeader(Edit edit) {
+    fstream f(SNAPSHOT_PATH,ios::binary|ios::in|ios::out);
+    SnapshotHeader h;
+    f.read(reinterpret_cast<char*>(&h),sizeof(h));
+    edit(h);
+    f.seekp(0);
+    f.write(reinterpret_cast<const char*>(&h),sizeof(h));
+}
+Attraction place(int id,const string& name,double lat,double lon) {
+    Attraction a;
+    a.id=id;
+    a.name=name;
+    a.latitude=lat;
+    a.longitude=lon;
+    return a;
+}
+// triangle a-b-c plus a pendant d on c
+Graph smallGraph() {
+    Graph g;
+    g.addAttraction(place(10,"a",26.470,73.110));
+    g.addAttraction(place(20,"b",26.471,73.111));
+    g.addAttraction(place(30,"c",26.472,73.112));
+    g.addAttraction(place(40,"d",26.473,73.113));
+    g.addEdge(0,1,2);
+    g.addEdge(1,2,3);
+    g.addEdge(0,2,7);
+    g.addEdge(2,3,1);
+    g.freeze();
+    g.buildDSU();
+    return g;
+}
+// Re-adding an attraction on a snapshot-backed graph must rebuild the adjacency
+// lists before the graph unfreezes.
+void testReAddAfterSnapshotLoad() {
+    Graph g=smallGraph();
+    CHECK(g.saveSnapshot(SNAPSHOT_PATH));
+    Graph h;
+    CHECK(h.loadSnapshot(SNAPSHOT_PATH));
+    int id=h.addAttraction(place(20,"b renamed",26.4715,73.1115));
+    CHECK(id==1);
+    CHECK(!h.isFrozen());
+    CHECK(h.getIdByName("b renamed")==1);
+    CHECK(h.getIdByName("b")==-1);
+    CHECK(h.getNeighbors(1).size()==2);
+    CHECK(h.getEdgeWeight(1,0)==2);
+    CHECK(h.getEdgeWeight(1,2)==3);
+    CHECK(h.getEdgeWeight(2,3)==1);
+    CHECK(!h.hasEdge(1,3));
+    h.freeze();
+    CHECK(h.getNeighbors(2).size()==3);
+    CHECK(h.getEdgeWeight(0,2)==7);
+    CHECK(h.latitudeOf(1)==26.4715);
+    remove(SNAPSHOT_PATH);
+}
+// A snapshot stays current only while its sources keep the stamped size and
+// modification time.
+void testSnapshotStaleness() {
+    writeFile(ATTRACTIONS_PATH,"name,category,rating,duration,fee,popularity,latitude,longitude\n"
+        "a,hostel,4,10,0,100,26.470,73.110\nb,hostel,4,10,0,100,26.471,73.111\n");
+    writeFile(ROADS_PATH,"from,to,time\na,b,1\n");
+    vector<string> sources={ATTRACTIONS_PATH,ROADS_PATH};
+    Graph g;
+    g.loadFromCSV(ATTRACTIONS_PATH,ROADS_PATH);
+    CHECK(g.size()==2);
+    CHECK(!snapshotIsCurrent(SNAPSHOT_PATH,sources));
+    CHECK(g.saveSnapshot(SNAPSHOT_PATH));
+    CHECK(snapshotIsCurrent(SNAPSHOT_PATH,sources));
+    CHECK(!snapshotIsCurrent(SNAPSHOT_PATH,{ROADS_PATH}));
+    // re-saving a loaded snapshot keeps the stamps
+    Graph h;
+    CHECK(h.loadSnapshot(SNAPSHOT_PATH));
+    CHECK(h.saveSnapshot(SNAPSHOT_PATH));
+    CHECK(snapshotIsCurrent(SNAPSHOT_PATH,sources));
+    // an edit right after the write, within the same second
+    writeFile(ROADS_PATH,"b,a,2\n",true);
+    CHECK(!snapshotIsCurrent(SNAPSHOT_PATH,sources));
+    // a snapshot whose sources were not shipped with it is still usable
+    remove(ROADS_PATH);
+    remove(ATTRACTIONS_PATH);
+    CHECK(snapshotIsCurrent(SNAPSHOT_PATH,sources));
+    remove(SNAPSHOT_PATH);
+}
+// A header claiming more source stamps than it has room for is rejected, not
+// read past its end.
+void testSourceCountOverflow() {
+    writeFile(ATTRACTIONS_PATH,"name,category,rating,duration,fee,popularity,latitude,longitude\na,hostel,4,10,0,100,26.47,73.11\n");
+    writeFile(ROADS_PATH,"from,to,time\n");
+    Graph g;
+    g.loadFromCSV(ATTRACTIONS_PATH,ROADS_PATH);
+    CHECK(g.saveSnapshot(SNAPSHOT_PATH));
+    editSnapshotHeader([](SnapshotHeader& h) { h.sourceCount=SNAPSHOT_MAX_SOURCES+3; });
+    CHECK(!snapshotIsCurrent(SNAPSHOT_PATH,vector<string>(SNAPSHOT_MAX_SOURCES+3,ATTRACTIONS_PATH)));
+    Graph h;
+    CHECK(!h.loadSnapshot(SNAPSHOT_PATH));
+    remove(SNAPSHOT_PATH);
+    remove(ATTRACTIONS_PATH);
+    remove(ROADS_PATH);
+}
+// The weight mode chosen by freeze() comes back from the snapshot unchanged,
+// and integer searches on the mapped weights give the same distances.
+void testWeightModeRoundTrip() {
+    for (double unit:{1.0,0.5,0.37}) {
+        Graph g=smallGraph();
+        if (unit!=1.0) {
+            g.addEdge(1,3,unit);
+            g.freeze();
+        }
+        CHECK(g.saveSnapshot(SNAPSHOT_PATH));
+        Graph h;
+        CHECK(h.loadSnapshot(SNAPSHOT_PATH));
+        CHECK(h.hasIntegerWeights()==g.hasIntegerWeights());
+        CHECK(h.integerWeightScale()==g.integerWeightScale());
+        CHECK(h.maxIntegerWeight()==g.maxIntegerWeight());
+        CHECK(h.hasUniformWeights()==g.hasUniformWeights());
+        for (int u=0; u<g.size() && g.hasIntegerWeights(); ++u)
+            for (int i=0; i<g.neighbors(u).size(); ++i) CHECK(h.intWeightsOf(u)[i]==g.intWeightsOf(u)[i]);
+        CHECK(dijkstra(h,0)==dijkstra(g,0));
+        remove(SNAPSHOT_PATH);
+    }
+    CHECK(smallGraph().integerWeightScale()==1);
+}
+// Only indexes the query precedence would consult get built, and a graph with
+// another set does not pass as configured.
+void testIndexSelection() {
+    SearchIndexOptions withLabels;
+    withLabels.hubLabels=true;
+    Graph g=smallGraph();
+    buildSearchIndexes(g,withLabels);
+    CHECK(g.landmarks()!=nullptr);
+    CHECK(g.allPairs()==nullptr); // opt-in
+    CHECK(g.contractionHierarchy()!=nullptr);
+    CHECK(g.hubLabelIndex()!=nullptr);
+    CHECK(hasSearchIndexes(g,withLabels));
+    CHECK(!hasSearchIndexes(g,SearchIndexOptions()));
+    SearchIndexOptions everything=withLabels;
+    everything.allPairs=true;
+    Graph h=smallGraph();
+    buildSearchIndexes(h,everything);
+    CHECK(h.allPairs()!=nullptr); // answers everything hub labels or the hierarchy could
+    CHECK(h.contractionHierarchy()==nullptr);
+    CHECK(h.hubLabelIndex()==nullptr);
+    CHECK(hasSearchIndexes(h,everything));
+    CHECK(!hasSearchIndexes(h,withLabels));
+    Graph bare=smallGraph();
+    CHECK(!hasSearchIndexes(bare,SearchIndexOptions()));
+}
+// Next hops are not scanned on load; a damaged table must still never send
+// path() out of bounds.
+void testDamagedAllPairsTable() {
+    SearchIndexOptions options;
+    options.allPairs=true;
+    Graph g=smallGraph();
+    buildSearchIndexes(g,options);
+    CHECK(g.saveSnapshot(SNAPSHOT_PATH));
+    vector<char> bytes;
+    {
+        ifstream in(SNAPSHOT_PATH,ios::binary);
+        bytes.assign(istreambuf_iterator<char>(in),istreambuf_iterator<char>());
+    }
+    SnapshotHeader h;
+    memcpy(&h,bytes.data(),sizeof(h));
+    const SnapshotSection* dir=reinterpret_cast<const SnapshotSection*>(bytes.data()+sizeof(h));
+    bool found=false;
+    for (uint32_t i=0; i<h.sectionCount; ++i) {
+        if (dir[i].kind!=SECTION_ALL_PAIRS) continue;
+        found=true;
+        size_t cells=(size_t)g.size()*g.size();
+        int32_t* next=reinterpret_cast<int32_t*>(bytes.data()+dir[i].offset+8+cells*sizeof(double));
+        for (size_t c=0; c<cells; c+=2) next[c]=c%4 ? 1000000 : -7;
+    }
+    CHECK(found);
+    {
+        ofstream out(SNAPSHOT_PATH,ios::binary|ios::trunc);
+        out.write(bytes.data(),bytes.size());
+    }
+    Graph loaded;
+    CHECK(loaded.loadSnapshot(SNAPSHOT_PATH));
+    CHECK(loaded.allPairs()!=nullptr);
+    for (int u=0; u<loaded.size(); ++u)
+        for (int v=0; v<loaded.size(); ++v) {
+            vector<int> p=loaded.allPairs()->path(u,v);
+            for (int x:p) CHECK(x>=0 && x<loaded.size());
+        }
+    remove(SNAPSHOT_PATH);
+}
+// side x side grid with unit weights
+Graph uniformGrid(int side) {
+    Graph g;
+    for (int i=0; i<side*side; ++i) g.addAttraction(place(i,"n"+to_string(i),26.8+(i/side)*0.0009,75.7+(i%side)*0.001));
+    for (int r=0; r<side; ++r)
+        for (int c=0; c<side; ++c) {
+            if (c+1<side) g.addEdge(r*side+c,r*side+c+1,1);
+            if (r+1<side) g.addEdge(r*side+c,(r+1)*side+c,1);
+        }
+    g.freeze();
+    g.buildDSU();
+    return g;
+}
+// n nodes a few km apart (all at (0, 0) when !placed), dealt round-robin into
+// `components` components that are each a random tree plus extra random roads;
+// weight(rng) gives each road's weight
+template <typename Weight>
+Graph randomGraph(int n,int extra,uint32_t seed,Weight weight,int components=1,bool placed=true) {
+    Graph g;
+    mt19937 rng(seed);
+    uniform_real_distribution<double> U(0,1);
+    vector<vector<int>> members(components);
+    for (int i=0; i<n; ++i) {
+        double lat=placed ? 26.8+U(rng)*0.05 : 0,lon=placed ? 75.7+U(rng)*0.05 : 0;
+        g.addAttraction(place(i,"r"+to_string(i),lat,lon));
+        members[i%components].push_back(i);
+    }
+    for (auto& m:members)
+        for (size_t i=1; i<m.size(); ++i) g.addEdge(m[i],m[rng()%i],weight(rng));
+    for (int e=0; e<extra; ++e) {
+        const vector<int>& m=members[rng()%components];
+        int u=m[rng()%m.size()],v=m[rng()%m.size()];
+        if (u!=v) g.addEdge(u,v,weight(rng));
+    }
+    g.freeze();
+    g.buildDSU();
+    return g;
+}
+double continuousWeight(mt19937& rng) { return uniform_real_distribution<double>(0.5,10.0)(rng); }
+bool close(double a,double b) { return a==b || fabs(a-b)<=1e-9*max(fabs(a),fabs(b)); }
+// path runs s..t over real roads and costs d; unreachable (d infinite) means empty
+bool validPath(const Graph& g,int s,int t,double d,const vector<int>& path) {
+    if (d==numeric_limits<double>::infinity()) return path.empty();
+    if (path.empty() || path.front()!=s || path.back()!=t) return false;
+    for (size_t i=0; i+1<path.size(); ++i) if (!g.hasEdge(path[i],path[i+1])) return false;
+    return close(g.pathCost(path),d);
+}
+// Hierarchy queries, shortcuts unpacked, give Dijkstra's distances along real
+// roads, and nothing across components.
+void testContractionHierarchy() {
+    Graph g=randomGraph(300,450,11,continuousWeight,2);
+    g.buildContractionHierarchy(2);
+    CHECK(g.contractionHierarchy()!=nullptr);
+    for (int s=0; s<g.size(); s+=7) {
+        vector<double> d=dijkstra(g,s);
+        for (int t=0; t<g.size(); t+=3) {
+            auto r=shortestPath(g,s,t);
+            CHECK(close(r.first,d[t]));
+            CHECK(validPath(g,s,t,d[t],r.second));
+        }
+    }
+}
+// The hierarchy's bucket many-to-many matrix matches one Dijkstra per source,
+// with infinity for pairs in different components and for invalid targets.
+void testHierarchyDistanceMatrix() {
+    Graph g=randomGraph(250,400,12,continuousWeight,3);
+    g.buildContractionHierarchy(2);
+    CHECK(g.allPairs()==nullptr && g.hubLabelIndex()==nullptr);
+    vector<int> sources,targets;
+    for (int v=0; v<g.size(); v+=9) sources.push_back(v);
+    for (int v=1; v<g.size(); v+=4) targets.push_back(v);
+    targets.push_back(sources[0]); // a source that is also a target
+    targets.push_back(g.size()+5);
+    vector<vector<double>> m=distanceMatrix(g,sources,targets);
+    CHECK(m.size()==sources.size());
+    int unreachable=0;
+    for (size_t i=0; i<sources.size(); ++i) {
+        vector<double> d=dijkstra(g,sources[i]);
+        CHECK(m[i].size()==targets.size());
+        for (size_t j=0; j<targets.size(); ++j) {
+            double expect=targets[j]<g.size() ? d[targets[j]] : numeric_limits<double>::infinity();
+            CHECK(close(m[i][j],expect));
+            if (expect==numeric_limits<double>::infinity()) ++unreachable;
+        }
+    }
+    CHECK(unreachable>(int)sources.size()); // disconnected pairs were covered
+}
+// Pruned hub labels answer every pair as Dijkstra does, before and after a
+// snapshot round trip of SECTION_HUB_LABELS.
+void testHubLabels() {
+    // continuous weights keep double distances, scale-100 weights store scaled uint32
+    for (int scale:{0,100}) {
+        auto weight=[&](mt19937& rng) {
+            if (scale==0) return continuousWeight(rng);
+            return (1+rng()%1000)/(double)scale;
+        };
+        Graph g=randomGraph(200,350,13,weight,2);
+        g.buildHubLabels();
+        CHECK(g.hubLabelIndex()!=nullptr);
+        CHECK(g.hubLabelIndex()->scale()==scale);
+        CHECK(g.saveSnapshot(SNAPSHOT_PATH));
+        Graph loaded;
+        CHECK(loaded.loadSnapshot(SNAPSHOT_PATH));
+        CHECK(loaded.hubLabelIndex()!=nullptr);
+        CHECK(loaded.hubLabelIndex()->entryCount()==g.hubLabelIndex()->entryCount());
+        CHECK(loaded.hubLabelIndex()->bytes()==g.hubLabelIndex()->bytes());
+        vector<int> all=g.getAllAttractionIds();
+        for (const Graph* h:{&g,&loaded}) {
+            const HubLabels* hl=h->hubLabelIndex();
+            for (int s=0; s<g.size(); ++s) {
+                vector<double> d=dijkstra(g,s);
+                for (int t=0; t<g.size(); ++t) CHECK(close(hl->distance(s,t),d[t]));
+            }
+            CHECK(hl->distance(-1,0)==numeric_limits<double>::infinity());
+            CHECK(hl->distance(0,g.size())==numeric_limits<double>::infinity());
+            vector<vector<double>> m=distanceMatrix(*h,all,all);
+            for (int s=0; s<g.size(); ++s)
+                for (int t=0; t<g.size(); ++t) CHECK(m[s][t]==hl->distance(s,t));
+        }
+        remove(SNAPSHOT_PATH);
+    }
+}
+// ALT bounds never exceed the true distance, and both ALT queries (one-way and
+// bidirectional with averaged potentials) stay exact, with or without positions.
+void testLandmarkQueries() {
+    for (bool placed:{true,false}) {
+        Graph g=randomGraph(220,300,14,continuousWeight,2,placed);
+        g.buildLandmarks(4);
+        const LandmarkIndex* lm=g.landmarks();
+        CHECK(lm!=nullptr && lm->count()==4);
+        SearchWorkspace fwd,bwd;
+        for (int s=0; s<g.size(); s+=5) {
+            vector<double> d=dijkstra(g,s);
+            for (int t=0; t<g.size(); t+=3) {
+                CHECK(lm->lowerBound(s,t)<=d[t]*(1+1e-12));
+                auto one=altPath(g,*lm,s,t,fwd);
+                CHECK(close(one.first,d[t]));
+                CHECK(validPath(g,s,t,d[t],one.second));
+                auto both=altBidirectionalPath(g,*lm,s,t,fwd,bwd);
+                CHECK(close(both.first,d[t]));
+                CHECK(validPath(g,s,t,d[t],both.second));
+            }
+        }
+    }
+}
+// bidirectionalAStarPath is exact on every potential it may pick: landmarks,
+// the geometric bound, or none (no landmarks and no positions). Also aStarPath.
+void testBidirectionalAStar() {
+    for (bool placed:{true,false})
+        for (bool landmarks:{false,true}) {
+            Graph g=randomGraph(220,300,15,continuousWeight,2,placed);
+            if (landmarks) g.buildLandmarks(4);
+            CHECK(g.hasGeometricBound()==placed);
+            for (int s=0; s<g.size(); s+=5) {
+                vector<double> d=dijkstra(g,s);
+                for (int t=0; t<g.size(); t+=3) {
+                    CHECK(validPath(g,s,t,d[t],bidirectionalAStarPath(g,s,t)));
+                    CHECK(validPath(g,s,t,d[t],aStarPath(g,s,t)));
+                }
+            }
+        }
+}
+// bidirectionalDijkstra joins its two trees into the same path and distance as
+// one-way Dijkstra (continuous weights, so shortest paths are unique).
+void testBidirectionalDijkstra() {
+    Graph g=randomGraph(250,350,16,continuousWeight,2);
+    SearchWorkspace fwd,bwd;
+    for (int s=0; s<g.size(); s+=7) {
+        auto tree=dijkstraWithPath(g,s);
+        for (int t=0; t<g.size(); t+=2) {
+            auto r=bidirectionalDijkstra(g,s,t,fwd,bwd);
+            CHECK(close(r.first,tree.first[t]));
+            if (tree.first[t]==numeric_limits<double>::infinity()) CHECK(r.second.empty());
+            else CHECK(r.second==reconstructPath(tree.second,s,t));
+        }
+    }
+    CHECK(bidirectionalDijkstra(g,0,g.size(),fwd,bwd).second.empty());
+}
+// Plain lazy-deletion binary-heap Dijkstra on the double weights, as reference.
+vector<double> heapDistances(const Graph& g,int s) {
+    vector<double> dist(g.size(),numeric_limits<double>::infinity());
+    priority_queue<pair<double,int>,vector<pair<double,int>>,greater<pair<double,int>>> pq;
+    dist[s]=0;
+    pq.push({0,s});
+    while (!pq.empty()) {
+        auto [d,u]=pq.top();
+        pq.pop();
+        if (d>dist[u]) continue;
+        for (Neighbor nb:g.neighbors(u))
+            if (d+nb.weight<dist[nb.id]) { dist[nb.id]=d+nb.weight; pq.push({dist[nb.id],nb.id}); }
+    }
+    return dist;
+}
+// Each integer queue (Dial's buckets up to DIAL_MAX_WEIGHT, the radix heap
+// above) and the scaled modes give the heap search's distances.
+void testIntegerWeightSearches() {
+    struct Case { int scale; uint32_t maxWeight; bool dial; };
+    for (Case c:{Case{1,50,true},Case{1,100000,false},Case{10,500,true},Case{100,5000,false},Case{0,0,false}}) {
+        auto weight=[&](mt19937& rng) {
+            if (c.scale==0) return continuousWeight(rng);
+            return (1+rng()%c.maxWeight)/(double)c.scale;
+        };
+        Graph g=randomGraph(300,500,17+c.scale,weight,2);
+        CHECK(g.integerWeightScale()==c.scale);
+        CHECK(g.hasIntegerWeights()==(c.scale>0));
+        if (c.scale>0) CHECK((g.maxIntegerWeight()<=1024)==c.dial);
+        SearchWorkspace ws;
+        vector<int> targets={3,g.size()-1,150,1};
+        for (int s=0; s<g.size(); s+=13) {
+            vector<double> expect=heapDistances(g,s);
+            vector<double> d=dijkstra(g,s);
+            for (int v=0; v<g.size(); ++v) CHECK(close(d[v],expect[v]));
+            vector<double> row=dijkstraToTargets(g,s,targets,ws);
+            for (size_t j=0; j<targets.size(); ++j) CHECK(close(row[j],expect[targets[j]]));
+        }
+    }
+}
+// Every distance and next-hop walk of an all-pairs table against Dijkstra.
+void checkAllPairs(const Graph& g,const AllPairsTable& ap) {
+    CHECK(ap.size()==g.size());
+    for (int s=0; s<g.size(); ++s) {
+        vector<double> d=dijkstra(g,s);
+        for (int t=0; t<g.size(); ++t) {
+            CHECK(close(ap.distance(s,t),d[t]));
+            CHECK(validPath(g,s,t,d[t],ap.path(s,t)));
+        }
+    }
+}
+// The two weighted all-pairs builders: blocked Floyd-Warshall (small sparse or
+// dense graphs) and repeated Dijkstra over threads (larger sparse ones).
+void testAllPairsBuilders() {
+    Graph small=randomGraph(60,40,18,continuousWeight,2);   // n <= 64: Floyd-Warshall
+    Graph dense=randomGraph(130,4500,19,continuousWeight,2); // degree >= n/2: Floyd-Warshall, several tiles
+    Graph sparse=randomGraph(300,300,20,continuousWeight,3); // repeated Dijkstra
+    for (const Graph* g:{&small,&dense,&sparse}) {
+        auto ap=AllPairsTable::build(*g,3);
+        CHECK(ap!=nullptr);
+        if (ap) checkAllPairs(*g,*ap);
+    }
+}
+// Bit-parallel BFS over more than one 64-source batch (last one partial, with
+// an invalid source), its BFS-tree paths, and the all-pairs table built from it.
+void testMultiSourceBFS() {
+    const double w=2.5;
+    Graph g=randomGraph(200,250,21,[&](mt19937&) { return w; },2);
+    CHECK(g.hasUniformWeights());
+    vector<int> sources;
+    for (int v=0; v<150; ++v) sources.push_back((v*7)%g.size());
+    sources[70]=-1;
+    HopTable h=multiSourceBFS(g,sources);
+    CHECK(h.nodeCount==g.size());
+    for (size_t i=0; i<sources.size(); ++i) {
+        int s=sources[i];
+        vector<double> d=s>=0 ? dijkstra(g,s) : vector<double>(g.size(),numeric_limits<double>::infinity());
+        for (int v=0; v<g.size(); ++v) {
+            bool reached=d[v]<numeric_limits<double>::infinity();
+            CHECK(h.hopCount((int)i,v)==(reached ? (int)llround(d[v]/w) : -1));
+            vector<int> p=h.path((int)i,v);
+            CHECK(validPath(g,s,v,d[v],p));
+            if (reached) CHECK((int)p.size()==h.hopCount((int)i,v)+1);
+        }
+    }
+    auto ap=AllPairsTable::build(g,2);
+    CHECK(ap!=nullptr);
+    if (ap) checkAllPairs(g,*ap);
+}
+// The chunked importer on several threads (input well above MIN_CHUNK_BYTES)
+// builds the same graph and counts as a single-threaded import, merged in file
+// order, with rejected roads and malformed fields counted once.
+void testParallelImport() {
+    const int places=3000,roads=9000;
+    string a="name,category,rating,duration,fee,popularity,latitude,longitude\n";
+    for (int i=0; i<places; ++i) {
+        a+="place number "+to_string(i)+",museum,"+(i%97==0 ? string("x4") : to_string(1+i%5))+",30,0,"+to_string(i);
+        a+=","+to_string(26.8+i*1e-5)+","+to_string(75.7+i*1e-5)+(i%11==0 ? "\r\n" : "\n");
+    }
+    string r="from,to,time\n";
+    int rejected=0,malformedTimes=0;
+    mt19937 rng(22);
+    for (int e=0; e<roads; ++e) {
+        int u=rng()%places,v=rng()%places;
+        bool bad=e%50==0,slow=e%70==1;
+        rejected+=bad;
+        malformedTimes+=slow;
+        r+="place number "+to_string(u)+","+(bad ? string("nowhere") : "place number "+to_string(v))+",";
+        r+=(slow ? string("fast") : to_string(1+rng()%30))+"\n";
+    }
+    CHECK(a.size()>2*65536 && r.size()>2*65536); // several MIN_CHUNK_BYTES chunks each
+    writeFile(ATTRACTIONS_PATH,a);
+    writeFile(ROADS_PATH,r);
+    Graph one,many;
+    ImportStats s1=importGraphCSV(one,ATTRACTIONS_PATH,ROADS_PATH,1);
+    ImportStats s4=importGraphCSV(many,ATTRACTIONS_PATH,ROADS_PATH,4);
+    CHECK(s1.threads==1 && s4.threads>1);
+    for (const ImportStats& st:{s1,s4}) {
+        CHECK(st.attractionRows==places);
+        CHECK(st.roadRows==roads);
+        CHECK(st.rejectedRows==rejected);
+        CHECK(st.malformedFields==(places+96)/97+malformedTimes);
+    }
+    CHECK(one.size()==places && many.size()==places);
+    for (int v=0; v<places; ++v) {
+        CHECK(many.getIdByName("place number "+to_string(v))==v);
+        CHECK(many.getAttraction(v).rating==one.getAttraction(v).rating);
+        CHECK(many.longitudeOf(v)==one.longitudeOf(v));
+        NeighborRange x=one.neighbors(v),y=many.neighbors(v);
+        CHECK(x.size()==y.size());
+        for (int i=0; i<x.size() && i<y.size(); ++i) CHECK(x[i].id==y[i].id && x[i].weight==y[i].weight);
+    }
+    remove(ATTRACTIONS_PATH);
+    remove(ROADS_PATH);
+}
+// NameIndex against std::map through inserts, replacements, erases (leaving
+// tombstones), reinserts and the rehashes they trigger.
+void testNameIndex() {
+    NameIndex idx;
+    CHECK(idx.find("a")==-1);
+    idx.erase("a"); // erase on an empty table
+    idx.insert("ab",1);
+    idx.insert("a",2);
+    idx.insert("ab",3); // replaces
+    CHECK(idx.size()==2 && idx.find("ab")==3 && idx.find("a")==2 && idx.find("abc")==-1);
+    idx.erase("ab");
+    idx.erase("ab");
+    CHECK(idx.size()==1 && idx.find("ab")==-1 && idx.find("a")==2);
+    idx.insert("ab",4); // reinsert over its tombstone
+    CHECK(idx.size()==2 && idx.find("ab")==4);
+    map<string,int> model={{"a",2},{"ab",4}};
+    mt19937 rng(23);
+    for (int op=0; op<40000; ++op) {
+        string name="name "+to_string(rng()%600);
+        if (rng()%3==0) {
+            idx.erase(name);
+            model.erase(name);
+        } else {
+            int id=(int)(rng()%100000);
+            idx.insert(name,id);
+            model[name]=id;
+        }
+        if (op%1000==0 || op>39000) {
+            CHECK(idx.size()==(int)model.size());
+            for (int k=0; k<600; ++k) {
+                string probe="name "+to_string(k);
+                auto it=model.find(probe);
+                CHECK(idx.find(probe)==(it==model.end() ? -1 : it->second));
+            }
+        }
+    }
+    idx.clear();
+    CHECK(idx.size()==0 && idx.find("a")==-1);
+    idx.reserve(1000);
+    for (int k=0; k<1000; ++k) idx.insert(to_string(k),k);
+    for (int k=0; k<1000; ++k) CHECK(idx.find(to_string(k))==k);
+}
+// Between a modification and the next freeze, searches must not read stale
+// positions, scaled weights or a bound a new cheaper road breaks.
+void testSearchesBeforeRefreeze() {
+    Graph g=smallGraph();
+    CHECK(g.hasGeometricBound() && g.hasIntegerWeights());
+    int e=g.addAttraction(place(50,"e",26.4725,73.1125));
+    g.addEdge(3,e,0.001); // far cheaper per meter than any frozen road
+    CHECK(!g.isFrozen());
+    CHECK(!g.hasGeometricBound() && !g.hasIntegerWeights() && !g.hasUniformWeights());
+    CHECK(g.latitudeOf(e)==26.4725 && g.hasCoordinates(e));
+    CHECK(g.geometricLowerBound(0,e)==0);
+    CHECK(aStarPath(g,0,e).empty()); // the new road is not searchable yet
+    CHECK(aStarPath(g,e,0).empty());
+    CHECK(dijkstra(g,e)[0]==numeric_limits<double>::infinity());
+    CHECK(validPath(g,0,3,6,aStarPath(g,0,3)));
+    g.freeze();
+    CHECK(g.hasGeometricBound());
+    CHECK(g.geometricCostPerMeter()<=0.001/haversine(g.latitudeOf(3),g.longitudeOf(3),26.4725,73.1125));
+    CHECK(validPath(g,0,e,6.001,aStarPath(g,0,e)));
+}
+// Uniform-weight matrices agree with plain Dijkstra whether they take the
+// bit-parallel BFS (small graph) or the bounded searches (large graph, few
+// targets), and a target-bounded BFS still fills every target's row.
+void testUniformDistanceMatrix() {
+    for (int side:{8,40}) {
+        Graph g=uniformGrid(side);
+        CHECK(g.hasUniformWeights());
+        vector<int> sources={0,side*side-1,side*side/2,7},targets={side-1,side*side/2+1,0,-3};
+        vector<vector<double>> m=distanceMatrix(g,sources,targets);
+        HopTable h=multiSourceBFS(g,sources,targets);
+        for (size_t i=0; i<sources.size(); ++i) {
+            vector<double> d=dijkstra(g,sources[i]);
+            for (size_t j=0; j<targets.size(); ++j) {
+                int t=targets[j];
+                CHECK(m[i][j]==(t<0 ? numeric_limits<double>::infinity() : d[t]));
+                if (t>=0) CHECK(h.hopCount((int)i,t)==(int)d[t]);
+            }
+        }
+    }
+}
+// The unit-vector distance the A* bound uses matches the scalar haversine, and
+// a snapshot hands back the same points and components instead of rebuilding.
+void testGeoPointsAndComponents() {
+    Graph g=smallGraph();
+    g.addAttraction(place(50,"far",-33.86,151.21)); // a second component
+    g.addAttraction(place(60,"antipode",-26.47,-106.89));
+    g.addEdge(4,5,100);
+    g.freeze();
+    g.buildDSU();
+    const GeoPoints& p=g.geoPoints();
+    for (int i=0; i<g.size(); ++i)
+        for (int j=0; j<g.size(); ++j) {
+            double expect=haversine(g.latitudeOf(i),g.longitudeOf(i),g.latitudeOf(j),g.longitudeOf(j));
+            CHECK(fabs(greatCircleDistance(p,i,j)-expect)<=1e-3+1e-9*expect);
+        }
+    CHECK(g.saveSnapshot(SNAPSHOT_PATH));
+    Graph h;
+    CHECK(h.loadSnapshot(SNAPSHOT_PATH));
+    CHECK(h.geoPoints().size()==p.size());
+    for (int i=0; i<g.size(); ++i) {
+        CHECK(h.geoPoints().x[i]==p.x[i] && h.geoPoints().y[i]==p.y[i] && h.geoPoints().z[i]==p.z[i]);
+        CHECK(h.geoPoints().lat[i]==p.lat[i] && h.geoPoints().lon[i]==p.lon[i] && h.geoPoints().cosLat[i]==p.cosLat[i]);
+        CHECK(h.getComponent(i)==g.getComponent(i));
+    }
+    CHECK(h.getComponent(0)==h.getComponent(3));
+    CHECK(h.getComponent(0)!=h.getComponent(4));
+    CHECK(!h.isFullyConnected());
+    remove(SNAPSHOT_PATH);
+}
+// The batch, matrix and equirectangular kernels against the scalar haversine,
+// and nearestNode against a brute-force scan that skips unplaced nodes.
+void testGeoKernels() {
+    Graph g=uniformGrid(12); // ~1 km across, near Jaipur
+    g.addAttraction(place(1000,"far",26.95,75.85)); // ~20 km out
+    g.addAttraction(place(1001,"unplaced",0,0));
+    g.freeze();
+    const GeoPoints& p=g.geoPoints();
+    int n=g.size();
+    vector<double> out(n);
+    for (auto q:{make_pair(26.805,75.705),make_pair(26.9,75.8),make_pair(-33.86,151.21)}) {
+        greatCircleBatch(q.first,q.second,p,out.data());
+        for (int i=0; i<n; ++i) {
+            double expect=haversine(q.first,q.second,g.latitudeOf(i),g.longitudeOf(i));
+            CHECK(fabs(out[i]-expect)<=1e-6+1e-9*expect);
+        }
+        equirectangularBatch(q.first,q.second,p,out.data());
+        for (int i=0; i<n; ++i) {
+            double expect=haversine(q.first,q.second,g.latitudeOf(i),g.longitudeOf(i));
+            if (expect<=10000) CHECK(fabs(out[i]-expect)<=1e-6+1e-6*expect); // documented bound
+            else if (expect<=50000) CHECK(fabs(out[i]-expect)<=1e-6+2.1e-5*expect);
+        }
+        int best=-1;
+        double bestDist=0;
+        for (int i=0; i<n; ++i) {
+            if (!g.hasCoordinates(i)) continue;
+            double d=haversine(q.first,q.second,g.latitudeOf(i),g.longitudeOf(i));
+            if (best<0 || d<bestDist) { best=i; bestDist=d; }
+        }
+        CHECK(nearestNode(g,q.first,q.second)==best);
+    }
+    CHECK(nearestNode(g,0,0)!=n-1);
+    CHECK(nearestNode(Graph(),26.9,75.8)==-1);
+    vector<int> rows={0,5,n-2,n-1},cols={3,n-2,77};
+    vector<vector<double>> m=greatCircleMatrix(p,rows,cols);
+    CHECK(m.size()==rows.size());
+    for (size_t i=0; i<rows.size(); ++i)
+        for (size_t j=0; j<cols.size(); ++j) {
+            double expect=haversine(g.latitudeOf(rows[i]),g.longitudeOf(rows[i]),g.latitudeOf(cols[j]),g.longitudeOf(cols[j]));
+            CHECK(fabs(m[i][j]-expect)<=1e-6+1e-9*expect);
+        }
+}
+// The calibrated A* bound is read from the snapshot header, not recomputed;
+// a header value that is not a usable cost falls back to calibration.
+void testGeoBoundFromHeader() {
+    Graph g=smallGraph();
+    CHECK(g.hasGeometricBound());
+    CHECK(g.saveSnapshot(SNAPSHOT_PATH));
+    for (double stored:{g.geometricCostPerMeter()*0.5,nan(""),-1.0}) {
+        editSnapshotHeader([&](SnapshotHeader& h) { h.geoCostPerMeter=stored; });
+        Graph loaded;
+        CHECK(loaded.loadSnapshot(SNAPSHOT_PATH));
+        CHECK(loaded.geometricCostPerMeter()==(stored>=0 ? stored : g.geometricCostPerMeter()));
+    }
+    remove(SNAPSHOT_PATH);
+}
+// Hierarchy legs report the nodes their queries settled, table lookups none,
+// and epsilon>0 is reported as bypassing both indexes.
+void testLegSearchReporting() {
+    SearchIndexOptions tableOptions;
+    tableOptions.allPairs=true;
+    for (bool table:{false,true}) {
+        Graph g=smallGraph();
+        buildSearchIndexes(g,table ? tableOptions : SearchIndexOptions());
+        auto snapshot=makeSnapshot(move(g));
+        for (double epsilon:{0.0,0.5}) {
+            RouteOptimizer optimizer;
+            optimizer.setGraph(snapshot);
+            RouteOptions options;
+            options.epsilon=epsilon;
+            optimizer.setOptions(options);
+            RouteResult r=optimizer.computeOptimalRoute({0,3,1},false);
+            CHECK(r.totalTime==10);
+            if (epsilon>0) CHECK(r.legSearch=="weighted A*" && r.settledNodes>0);
+            else if (table) CHECK(r.legSearch=="all-pairs table" && r.settledNodes==0);
+            else CHECK(r.legSearch=="contraction hierarchy" && r.settledNodes>0);
+        }
+    }
+}
+}
+int main() {
+    testReAddAfterSnapshotLoad();
+    testSnapshotStaleness();
+    testSourceCountOverflow();
+    testWeightModeRoundTrip();
+    testIndexSelection();
+    testDamagedAllPairsTable();
+    testUniformDistanceMatrix();
+    testGeoPointsAndComponents();
+    testGeoKernels();
+    testGeoBoundFromHeader();
+    testLegSearchReporting();
+    testContractionHierarchy();
+    testHierarchyDistanceMatrix();
+    testHubLabels();
+    testLandmarkQueries();
+    testBidirectionalAStar();
+    testBidirectionalDijkstra();
+    testIntegerWeightSearches();
+    testAllPairsBuilders();
+    testMultiSourceBFS();
+    testParallelImport();
+    testNameIndex();
+    testSearchesBeforeRefreeze();
+    if (failures) {
+        printf("%d check(s) failed\n",failures);
+        return 1;
+    }
+    printf("all graph tests passed\n");
+    return 0;
+}